@@ -0,0 +1,184 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TRandom3.h"
+
+#include "Globals.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Generates synthetic higs_data trees with the same branch layout as the
+/// converter writes (clover_cross, clover_back, misc, cebr_all, and the
+/// extended_timestamp), so HigsFrame can be benchmarked without beam-time data.
+///
+/// Each detector type has 16 channels, channels without a hit are NaN. The
+/// number of hits per event is poisson distributed with a configurable mean
+/// for each detector type, and a configurable fraction of the hit channels
+/// get a NaN amplitude (e.g. to mimic pileup). The energies are taken from a
+/// few gamma lines on top of a flat background and converted to channels
+/// using a gain similar to the one in examples/April2025.cal.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+constexpr int    kChannels = 16;
+constexpr double kGain     = 0.16;   // keV/channel
+
+struct Detector {
+   std::string                      fName;
+   std::vector<std::string>         fLeaves;
+   std::vector<std::vector<double>> fValues;
+   double                           fMultiplicity{1.};
+};
+
+void FillDetector(Detector& detector, TRandom3& random, double nanFraction, double timestamp)
+{
+   for(auto& values : detector.fValues) {
+      values.assign(kChannels, NAN);
+   }
+   int hits = std::min(random.Poisson(detector.fMultiplicity), kChannels);
+   for(int hit = 0; hit < hits; ++hit) {
+      auto channel = static_cast<size_t>(random.Integer(kChannels));
+      // gamma lines at 511, 1173, and 1332 keV on top of a flat background
+      double energy = 0.;
+      switch(random.Integer(4)) {
+      case 0: energy = random.Gaus(511., 1.5); break;
+      case 1: energy = random.Gaus(1173.2, 1.8); break;
+      case 2: energy = random.Gaus(1332.5, 1.9); break;
+      default: energy = random.Uniform(0., 2000.); break;
+      }
+      bool nan = random.Uniform() < nanFraction;
+      for(size_t leaf = 0; leaf < detector.fLeaves.size(); ++leaf) {
+         const auto& name = detector.fLeaves[leaf];
+         if(name == "amplitude" || name == "integration_long") {
+            detector.fValues[leaf][channel] = nan ? NAN : std::floor(energy / kGain);
+         } else if(name == "pileup") {
+            detector.fValues[leaf][channel] = nan ? 1. : 0.;
+         } else if(name == "module_timestamp") {
+            detector.fValues[leaf][channel] = timestamp;
+         } else {
+            // channel_time and trigger_time
+            detector.fValues[leaf][channel] = std::floor(random.Gaus(1000., 20.));
+         }
+      }
+   }
+}
+}   // namespace
+
+int main(int argc, char** argv)
+{
+   std::string           prefix      = "synthetic";
+   int                   files       = 1;
+   Long64_t              entries     = 100000;
+   Long64_t              clusterSize = 0;   // 0 = ROOT default
+   double                nanFraction = 0.;
+   ULong_t               seed        = 4357;
+   std::array<double, 4> multiplicity{2., 1., 0.5, 1.};
+
+   bool parseError = false;
+   for(int i = 1; i < argc; ++i) {
+      if(strcmp(argv[i], "--output-prefix") == 0 || strcmp(argv[i], "-o") == 0) {
+         prefix = argv[++i];
+         continue;
+      }
+      if(strcmp(argv[i], "--files") == 0 || strcmp(argv[i], "-f") == 0) {
+         files = std::stoi(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--entries") == 0 || strcmp(argv[i], "-e") == 0) {
+         entries = std::stoll(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--cluster-size") == 0 || strcmp(argv[i], "-c") == 0) {
+         clusterSize = std::stoll(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--multiplicity") == 0 || strcmp(argv[i], "-m") == 0) {
+         for(auto& mult : multiplicity) {
+            if(i + 1 >= argc) {
+               parseError = true;
+               break;
+            }
+            mult = std::stod(argv[++i]);
+         }
+         continue;
+      }
+      if(strcmp(argv[i], "--nan-fraction") == 0 || strcmp(argv[i], "-n") == 0) {
+         nanFraction = std::stod(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--seed") == 0 || strcmp(argv[i], "-s") == 0) {
+         seed = std::stoul(argv[++i]);
+         continue;
+      }
+      std::cout << "Unkown command line option \"" << argv[i] << "\":" << std::endl;
+      parseError = true;
+   }
+
+   if(parseError || files < 1 || entries < 1) {
+      std::cout << "Commandline arguments for " << argv[0] << ":" << std::endl
+                << "--output-prefix  <prefix of output files>                                  optional (default synthetic)" << std::endl
+                << "--files          <number of files>                                         optional (default 1)" << std::endl
+                << "--entries        <entries per file>                                        optional (default 100000)" << std::endl
+                << "--cluster-size   <entries per cluster>                                     optional (default from ROOT)" << std::endl
+                << "--multiplicity   <mean hits of cross> <back> <misc> <cebr>                 optional (default 2 1 0.5 1)" << std::endl
+                << "--nan-fraction   <fraction of hits with NaN amplitude>                     optional (default 0)" << std::endl
+                << "--seed           <random seed>                                             optional (default 4357)" << std::endl;
+      return 1;
+   }
+
+   std::vector<Detector> detectors = {
+      {"clover_cross", {"amplitude", "channel_time", "module_timestamp", "pileup", "trigger_time"}, {}, multiplicity[0]},
+      {"clover_back", {"amplitude", "channel_time", "module_timestamp", "pileup", "trigger_time"}, {}, multiplicity[1]},
+      {"misc", {"amplitude", "channel_time", "module_timestamp", "pileup", "trigger_time"}, {}, multiplicity[2]},
+      {"cebr_all", {"channel_time", "integration_long", "module_timestamp", "trigger_time"}, {}, multiplicity[3]}};
+   for(auto& detector : detectors) {
+      detector.fValues.resize(detector.fLeaves.size());
+   }
+   std::vector<double> extendedTimestamp(1, 0.);
+
+   TRandom3 random(seed);
+   double   timestamp = 0.;
+
+   for(int file = 0; file < files; ++file) {
+      // name the files like the converter does, so HigsFrame gets a run number from them
+      std::string fileName = Form("%s_run%03d.bin_tree.root", prefix.c_str(), file);
+      TFile       output(fileName.c_str(), "recreate");
+      if(!output.IsOpen()) {
+         std::cerr << DRED << "Failed to open " << fileName << RESET_COLOR << std::endl;
+         return 1;
+      }
+      auto* tree = new TTree("higs_data", "synthetic higs data");
+      if(clusterSize > 0) {
+         tree->SetAutoFlush(clusterSize);
+      }
+      for(auto& detector : detectors) {
+         for(size_t leaf = 0; leaf < detector.fLeaves.size(); ++leaf) {
+            tree->Branch(Form("%s.%s", detector.fName.c_str(), detector.fLeaves[leaf].c_str()), &detector.fValues[leaf]);
+         }
+      }
+      tree->Branch("extended_timestamp", &extendedTimestamp);
+
+      for(Long64_t entry = 0; entry < entries; ++entry) {
+         // on average 1000 timestamp units between events
+         timestamp += random.Exp(1000.);
+         extendedTimestamp[0] = std::floor(timestamp);
+         for(auto& detector : detectors) {
+            FillDetector(detector, random, nanFraction, extendedTimestamp[0]);
+         }
+         tree->Fill();
+      }
+      tree->Write();
+      output.Close();
+      std::cout << "Wrote " << entries << " entries to " << fileName << std::endl;
+   }
+
+   return 0;
+}
@@ -0,0 +1,342 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "TFile.h"
+#include "TH1F.h"
+#include "TSystem.h"
+#include "ROOT/RDataFrame.hxx"
+
+#include "Options.h"
+#include "Calibration.h"
+#include "CustomMap.h"
+#include "BasicHelper.h"
+#include "BasicFrame.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Micro-benchmarks of the individual pieces of libHigs: Calibration::Energy,
+/// CustomMap::at, BasicHelper::Setup, BasicHelper::CheckSizes,
+/// BasicHelper::Finalize, and BasicFrame::WriteOutput.
+///
+/// Each benchmark is run with a number of iterations that is increased until
+/// the timed section takes at least the minimum time, and this is repeated a
+/// few times. The output is one tab-separated line per benchmark and parameter
+/// with the median and minimum time per iteration, so results of different
+/// commits can be compared with e.g. diff or paste.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+volatile double gSink = 0.;   // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+/// A benchmark gets the number of iterations to run and returns the nanoseconds spent in the timed section.
+using Benchmark = std::function<double(size_t)>;
+
+class Stopwatch {
+public:
+   void   Start() { fStart = std::chrono::steady_clock::now(); }
+   void   Stop() { fElapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - fStart).count(); }
+   double Elapsed() const { return fElapsed; }
+
+private:
+   std::chrono::steady_clock::time_point fStart;
+   double                                fElapsed{0.};
+};
+
+class Harness {
+public:
+   Harness(std::string filter, double minTime, int repetitions)
+      : fFilter(std::move(filter)), fMinTime(minTime * 1e9), fRepetitions(repetitions)
+   {
+      std::cout << "# benchmark\tparameter\titerations\tns/iteration (median)\tns/iteration (min)" << std::endl;
+   }
+
+   void Run(const std::string& name, const std::string& parameter, const Benchmark& benchmark)
+   {
+      if(!fFilter.empty() && (name + "/" + parameter).find(fFilter) == std::string::npos) {
+         return;
+      }
+      // increase the number of iterations until we reach the minimum time
+      size_t iterations = 1;
+      while(true) {
+         double elapsed = benchmark(iterations);
+         if(elapsed >= fMinTime || iterations >= 1000000000) { break; }
+         // aim for 1.5 times the minimum time, but increase by at least a factor 2 and at most a factor 100
+         auto factor = (elapsed > 0. ? 1.5 * fMinTime / elapsed : 100.);
+         iterations  = static_cast<size_t>(static_cast<double>(iterations) * std::min(std::max(factor, 2.), 100.));
+      }
+      std::vector<double> perIteration;
+      for(int rep = 0; rep < fRepetitions; ++rep) {
+         perIteration.push_back(benchmark(iterations) / static_cast<double>(iterations));
+      }
+      std::sort(perIteration.begin(), perIteration.end());
+      std::cout << name << "\t" << parameter << "\t" << iterations << "\t" << std::fixed << std::setprecision(1) << perIteration[perIteration.size() / 2] << "\t" << perIteration.front() << std::endl;
+   }
+
+private:
+   std::string fFilter;
+   double      fMinTime;
+   int         fRepetitions;
+};
+
+/// Minimal helper that creates the requested number of 1D histograms in ten directories.
+class BenchmarkHelper : public BasicHelper {
+public:
+   BenchmarkHelper(TList* input, int histograms, bool lazy = false)
+      : BasicHelper(input), fHistograms(histograms)
+   {
+      Prefix("BenchmarkHelper");
+      LazySlots(lazy);
+   }
+   BenchmarkHelper(const BenchmarkHelper&)            = delete;
+   BenchmarkHelper(BenchmarkHelper&&)                 = delete;
+   BenchmarkHelper& operator=(const BenchmarkHelper&) = delete;
+   BenchmarkHelper& operator=(BenchmarkHelper&&)      = delete;
+   ~BenchmarkHelper()
+   {
+      // the helpers don't delete their histograms (ROOT's output list owns them), so we do it here
+      for(auto& lists : fLists) {
+         for(auto& list : *lists) {
+            list.second.Delete();
+         }
+      }
+      if(LazySlots()) {
+         for(auto& list : Prototype()) {
+            list.second.Delete();
+         }
+      }
+   }
+
+   void CreateHistograms(unsigned int slot) override
+   {
+      for(int i = 0; i < fHistograms; ++i) {
+         fH1[slot][Form("dir%d/h%d", i % 10, i)] = new TH1F(Form("h%d", i), Form("histogram %d", i), 1000, 0., 1000.);
+      }
+   }
+
+   void Check(unsigned int slot) { CheckSizes(slot, "benchmark"); }
+   void Fill()
+   {
+      // put a few entries in each histogram, so merging isn't trivial
+      for(auto& map : fH1) {
+         for(auto& hist : map) {
+            for(int i = 0; i < 100; ++i) {
+               hist.second->Fill(i * 7 % 1000);
+            }
+         }
+      }
+   }
+
+private:
+   int fHistograms;
+};
+
+std::string WriteCalibration()
+{
+   /// Writes a calibration file with 48 energy calibrations, and the time and timestamp calibration.
+   std::string   fileName = std::string(gSystem->TempDirectory()) + "/MicroBenchmarks.cal";
+   std::ofstream file(fileName);
+   for(int i = 0; i < 48; ++i) {
+      file << 0.1 * i << "\t" << 0.15 + 0.001 * i << std::endl;
+   }
+   file << "0\t0.0244140625" << std::endl;
+   file << "0\t0.0625" << std::endl;
+   return fileName;
+}
+}   // namespace
+
+int main(int argc, char** argv)
+{
+   std::string filter;
+   double      minTime     = 0.2;
+   int         repetitions = 5;
+
+   bool parseError = false;
+   for(int i = 1; i < argc; ++i) {
+      if(strcmp(argv[i], "--filter") == 0 || strcmp(argv[i], "-f") == 0) {
+         filter = argv[++i];
+         continue;
+      }
+      if(strcmp(argv[i], "--min-time") == 0 || strcmp(argv[i], "-t") == 0) {
+         minTime = std::stod(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--repetitions") == 0 || strcmp(argv[i], "-r") == 0) {
+         repetitions = std::stoi(argv[++i]);
+         continue;
+      }
+      std::cout << "Unkown command line option \"" << argv[i] << "\":" << std::endl;
+      parseError = true;
+   }
+   if(parseError || repetitions < 1) {
+      std::cout << "Commandline arguments for " << argv[0] << ":" << std::endl
+                << "--filter       <only run benchmarks containing this string>   optional" << std::endl
+                << "--min-time     <minimum time per measurement in seconds>      optional (default 0.2)" << std::endl
+                << "--repetitions  <number of measurements per benchmark>         optional (default 5)" << std::endl;
+      return 1;
+   }
+
+   Harness harness(filter, minTime, repetitions);
+
+   // enables ROOT's thread safety (the slots themselves are created explicitly via BasicHelper::Slots)
+   ROOT::EnableImplicitMT();
+
+   Options::Get()->SetCalibration(WriteCalibration().c_str());
+   auto* calibration = Options::Get()->GetCalibration();
+   auto* input       = new TList;
+   input->Add(calibration);
+
+   // Calibration::Energy for a loop over all 48 channels
+   harness.Run("Calibration::Energy", "48 channels", [calibration](size_t iterations) {
+      Stopwatch watch;
+      double    sum = 0.;
+      watch.Start();
+      for(size_t it = 0; it < iterations; ++it) {
+         for(int id = 0; id < 48; ++id) {
+            sum += calibration->Energy(static_cast<double>(it & 0xffff), id);
+         }
+      }
+      watch.Stop();
+      gSink = sum;
+      return watch.Elapsed();
+   });
+
+   // CustomMap::at with maps of different sizes, using std::string keys and string literals
+   for(int keys : {10, 100, 1000}) {
+      CustomMap<std::string, TH1*> map;
+      std::vector<std::string>     names;
+      for(int i = 0; i < keys; ++i) {
+         names.emplace_back(Form("dir%d/h%d", i % 10, i));
+         map[names.back()] = nullptr;
+      }
+      harness.Run("CustomMap::at(std::string)", std::to_string(keys) + " keys", [&map, &names](size_t iterations) {
+         Stopwatch watch;
+         size_t    found = 0;
+         watch.Start();
+         for(size_t it = 0; it < iterations; ++it) {
+            found += (map.at(names[it % names.size()]) == nullptr ? 1 : 0);
+         }
+         watch.Stop();
+         gSink = static_cast<double>(found);
+         return watch.Elapsed();
+      });
+      harness.Run("CustomMap::at(const char*)", std::to_string(keys) + " keys", [&map](size_t iterations) {
+         Stopwatch watch;
+         size_t    found = 0;
+         watch.Start();
+         for(size_t it = 0; it < iterations; ++it) {
+            found += (map.at("dir0/h0") == nullptr ? 1 : 0);
+         }
+         watch.Stop();
+         gSink = static_cast<double>(found);
+         return watch.Elapsed();
+      });
+      harness.Run("CustomMap::at(CustomMapKey)", std::to_string(keys) + " keys", [&map](size_t iterations) {
+         static constexpr CustomMapKey key("dir0/h0");
+         Stopwatch                     watch;
+         size_t                        found = 0;
+         watch.Start();
+         for(size_t it = 0; it < iterations; ++it) {
+            found += (map.at(key) == nullptr ? 1 : 0);
+         }
+         watch.Stop();
+         gSink = static_cast<double>(found);
+         return watch.Elapsed();
+      });
+   }
+
+   for(int histograms : {10, 100, 1000}) {
+      for(int slots : {1, 8, 32}) {
+         std::string parameter = std::to_string(histograms) + " histograms x " + std::to_string(slots) + " slots";
+         Options::Get()->MaxWorkers(slots);
+
+         harness.Run("BasicHelper::Setup", parameter, [input, histograms, slots](size_t iterations) {
+            Stopwatch watch;
+            for(size_t it = 0; it < iterations; ++it) {
+               BenchmarkHelper helper(input, histograms);
+               watch.Start();
+               helper.Setup();
+               helper.Slots(slots);
+               watch.Stop();
+            }
+            return watch.Elapsed();
+         });
+
+         // lazy slots: Setup creates the prototype, and each slot is cloned from it in InitTask
+         harness.Run("BasicHelper::InitTask (lazy slots)", parameter, [input, histograms, slots](size_t iterations) {
+            Stopwatch watch;
+            for(size_t it = 0; it < iterations; ++it) {
+               BenchmarkHelper helper(input, histograms, true);
+               watch.Start();
+               helper.Setup();
+               helper.Slots(slots);
+               for(int slot = 0; slot < slots; ++slot) {
+                  helper.InitTask(nullptr, slot);
+               }
+               watch.Stop();
+            }
+            return watch.Elapsed();
+         });
+
+         harness.Run("BasicHelper::CheckSizes", parameter, [input, histograms, slots](size_t iterations) {
+            Stopwatch       watch;
+            BenchmarkHelper helper(input, histograms);
+            helper.Setup();
+            helper.Slots(slots);
+            watch.Start();
+            for(size_t it = 0; it < iterations; ++it) {
+               for(int slot = 0; slot < slots; ++slot) {
+                  helper.Check(slot);
+               }
+            }
+            watch.Stop();
+            return watch.Elapsed();
+         });
+
+         harness.Run("BasicHelper::Finalize", parameter, [input, histograms, slots](size_t iterations) {
+            Stopwatch watch;
+            for(size_t it = 0; it < iterations; ++it) {
+               BenchmarkHelper helper(input, histograms);
+               helper.Setup();
+               helper.Slots(slots);
+               helper.Fill();
+               watch.Start();
+               helper.Finalize();
+               watch.Stop();
+            }
+            return watch.Elapsed();
+         });
+      }
+   }
+
+   // BasicFrame::WriteOutput of the histograms of one slot (including opening and closing the file)
+   Options::Get()->MaxWorkers(1);
+   std::string outputName = std::string(gSystem->TempDirectory()) + "/MicroBenchmarks.root";
+   for(int histograms : {10, 100, 1000}) {
+      BenchmarkHelper helper(input, histograms);
+      helper.Setup();
+      helper.Fill();
+      auto output = helper.GetResultPtr();
+      harness.Run("BasicFrame::WriteOutput", std::to_string(histograms) + " histograms", [&output, &outputName](size_t iterations) {
+         Stopwatch watch;
+         watch.Start();
+         for(size_t it = 0; it < iterations; ++it) {
+            TFile file(outputName.c_str(), "recreate");
+            BasicFrame::WriteOutput(*output);
+            file.Close();
+         }
+         watch.Stop();
+         return watch.Elapsed();
+      });
+   }
+   gSystem->Unlink(outputName.c_str());
+
+   return 0;
+}
@@ -0,0 +1,68 @@
+#!/bin/bash
+# Runs HigsFrame with a helper over (synthetic) input files for a range of thread counts
+# and prints the events per second for each thread count, as well as the speedup and
+# efficiency relative to the first thread count, using the performance report of HigsFrame.
+# If no input files are provided, synthetic data is generated using GenerateHigsData.
+
+set -euo pipefail
+
+usage() {
+	echo "Usage: $0 [-h <helper source or library>] [-c <calibration file>] [-t \"<thread counts>\"] [-w <work directory>] [-g \"<GenerateHigsData arguments>\"] [input files]"
+	echo "Defaults: helper \$HIGSSYS/examples/ExampleHelper.cxx, calibration \$HIGSSYS/examples/April2025.cal, thread counts \"1 2 4 8\", work directory higs_benchmark, generator arguments \"--files 4 --entries 250000\""
+	exit 1
+}
+
+helper="${HIGSSYS:-.}/examples/ExampleHelper.cxx"
+calibration="${HIGSSYS:-.}/examples/April2025.cal"
+threads="1 2 4 8"
+work="higs_benchmark"
+generate="--files 4 --entries 250000"
+
+while getopts "h:c:t:w:g:" option; do
+	case "${option}" in
+	h) helper="${OPTARG}" ;;
+	c) calibration="${OPTARG}" ;;
+	t) threads="${OPTARG}" ;;
+	w) work="${OPTARG}" ;;
+	g) generate="${OPTARG}" ;;
+	*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+mkdir -p "${work}"
+
+# we run HigsFrame in the work directory, so all paths need to be absolute
+helper=$(realpath "${helper}")
+calibration=$(realpath "${calibration}")
+
+inputs=()
+if [ $# -eq 0 ]; then
+	echo "No input files provided, generating synthetic data with arguments: ${generate}"
+	# shellcheck disable=SC2086
+	(cd "${work}" && GenerateHigsData --output-prefix synthetic ${generate})
+	for file in "${work}"/synthetic_run*.bin_tree.root; do
+		inputs+=("$(realpath "${file}")")
+	done
+else
+	for file in "$@"; do
+		inputs+=("$(realpath "${file}")")
+	done
+fi
+
+printf "%8s %16s %10s %10s\n" "threads" "events/s" "speedup" "efficiency"
+reference=""
+referenceThreads=""
+for n in ${threads}; do
+	report="perf_${n}.json"
+	if ! (cd "${work}" && HigsFrame --input "${inputs[@]}" --helper "${helper}" --calibration "${calibration}" --max-workers "${n}" --perf-report "${report}" >"higsframe_${n}.out" 2>&1); then
+		echo "HigsFrame failed for ${n} threads, see ${work}/higsframe_${n}.out"
+		exit 1
+	fi
+	rate=$(sed -n 's/^  "events_per_second": \([0-9.]*\),$/\1/p' "${work}/${report}")
+	if [ -z "${reference}" ]; then
+		reference="${rate}"
+		referenceThreads="${n}"
+	fi
+	awk -v n="${n}" -v rate="${rate}" -v ref="${reference}" -v refN="${referenceThreads}" 'BEGIN { speedup = (ref > 0 ? rate / ref : 0); printf "%8d %16.1f %10.2f %10.2f\n", n, rate, speedup, speedup * refN / n }'
+done
@@ -0,0 +1,70 @@
+#include "DerivedHelper.hh"
+
+void DerivedHelper::InitSlot(unsigned int slot)
+{
+   // coincidences within +- 100 ns (prompt) and 500-1000 ns (random)
+   fCoincidences[slot].Windows(100., 500., 1000.);
+}
+
+void DerivedHelper::CreateHistograms(unsigned int slot)
+{
+   int    energyBins = 10000;
+   double lowEnergy  = 0.;
+   double highEnergy = 2000.;
+
+   // single energy spectra
+   fH1[slot]["crossE"] = new TH1F("crossE", Form("Cross energy;energy [keV];counts/%.1f keV", (highEnergy - lowEnergy) / energyBins), energyBins, lowEnergy, highEnergy);
+   fH1[slot]["backE"]  = new TH1F("backE", Form("Back energy;energy [keV];counts/%.1f keV", (highEnergy - lowEnergy) / energyBins), energyBins, lowEnergy, highEnergy);
+   fH1[slot]["miscE"]  = new TH1F("miscE", Form("Misc energy;energy [keV];counts/%.1f keV", (highEnergy - lowEnergy) / energyBins), energyBins, lowEnergy, highEnergy);
+
+   // addback of the cross crystals (done when the cache was written)
+   fH1[slot]["crossAddbackE"] = new TH1F("crossAddbackE", Form("Cross energy using addback;energy [keV];counts/%.1f keV", (highEnergy - lowEnergy) / energyBins), energyBins, lowEnergy, highEnergy);
+
+   // coincidences between all clover crystals (cross and back)
+   fGG[slot]["ggPrompt"] = new SymmetricMatrix("ggPrompt", "Prompt #gamma#gamma matrix;energy [keV];energy [keV]", 2000, lowEnergy, highEnergy);
+   fGG[slot]["ggRandom"] = new SymmetricMatrix("ggRandom", "Random #gamma#gamma matrix;energy [keV];energy [keV]", 2000, lowEnergy, highEnergy);
+}
+
+void DerivedHelper::Process(unsigned int slot, const View& event)
+{
+   using namespace DerivedColumns;
+
+   HIGS_PROFILE(slot, "Exec");
+
+   // the energies and times are already calibrated, so the hit event doesn't get a calibration
+   auto& hits = HitEvent::ForSlot(slot, nullptr, "cross+back+misc");
+   if(hits.Begin(event.Get<Entry>())) {
+      HIGS_PROFILE(slot, "hit event");
+      hits.Add(0, 0, event.Get<CrossEnergy>(), event.Get<CrossTime>(), nullptr);
+      hits.Add(1, 16, event.Get<BackEnergy>(), event.Get<BackTime>(), nullptr);
+      hits.Add(2, 32, event.Get<MiscEnergy>(), event.Get<MiscTime>(), nullptr);
+   }
+
+   {
+      HIGS_PROFILE(slot, "singles");
+      const std::array<const char*, 3> names = {"crossE", "backE", "miscE"};
+      for(uint8_t type = 0; type < 3; ++type) {
+         auto* hist  = fH1[slot].at(names[type]);
+         auto  range = hits.Range(type);
+         for(size_t hit = range.first; hit < range.second; ++hit) {
+            hist->Fill(hits.Energy(hit));
+         }
+      }
+      auto* addback = fH1[slot].at("crossAddbackE");
+      for(auto energy : event.Get<CrossAddbackEnergy>()) {
+         addback->Fill(energy);
+      }
+   }
+
+   {
+      HIGS_PROFILE(slot, "coincidences");
+      // cross and back are the first hits of the hit event
+      auto& coincidences = fCoincidences[slot];
+      coincidences.Clear();
+      for(size_t hit = 0; hit < hits.Range(1).second; ++hit) {
+         coincidences.Add(hits.Type(hit), hits.Id(hit), hits.Energy(hit), hits.Time(hit));
+      }
+      coincidences.Sort();
+      coincidences.FillMatrices(fGG[slot].at("ggPrompt"), fGG[slot].at("ggRandom"));
+   }
+}
@@ -0,0 +1,43 @@
+#ifndef DERIVEDHELPER_HH
+#define DERIVEDHELPER_HH
+
+#include "ColumnHelper.h"
+
+// This helper uses the derived columns (calibrated energies and times, and the addback of the cross crystals) instead
+// of the raw amplitudes, so it needs to be run with --derived-cache <directory> (see DerivedCache.h). Compared to the
+// ExampleHelper it doesn't calibrate or run the addback for every event, these are read from the cache instead.
+namespace DerivedColumns {
+HIGS_COLUMN(CrossEnergy, "clover_cross_energy", double);
+HIGS_COLUMN(CrossTime, "clover_cross_time", double);
+HIGS_COLUMN(BackEnergy, "clover_back_energy", double);
+HIGS_COLUMN(BackTime, "clover_back_time", double);
+HIGS_COLUMN(MiscEnergy, "misc_energy", double);
+HIGS_COLUMN(MiscTime, "misc_time", double);
+HIGS_COLUMN(CrossAddbackEnergy, "clover_cross_addback_energy", double);
+HIGS_SCALAR_COLUMN(Entry, "rdfentry_", ULong64_t);   // entry number, used to build the hit event only once per event
+}   // namespace DerivedColumns
+
+class DerivedHelper : public ColumnHelper<DerivedHelper, DerivedColumns::CrossEnergy, DerivedColumns::CrossTime, DerivedColumns::BackEnergy, DerivedColumns::BackTime, DerivedColumns::MiscEnergy, DerivedColumns::MiscTime, DerivedColumns::CrossAddbackEnergy, DerivedColumns::Entry> {
+public:
+   explicit DerivedHelper(TList* list)
+      : ColumnHelper(list)
+   {
+      Prefix("DerivedHelper");
+      LazySlots(true);
+      Setup();
+   }
+
+   // coincidence windows for each slot
+   void InitSlot(unsigned int slot) override;
+   // this function creates and books all histograms (with lazy slots only for the prototype)
+   void CreateHistograms(unsigned int slot) override;
+   // this function gets called for every single event and fills the histograms
+   void Process(unsigned int slot, const View& event);
+};
+
+// These are needed functions used by TDataFrameLibrary to create and destroy the instance of this helper
+extern "C" DerivedHelper* CreateHelper(TList* list) { return new DerivedHelper(list); }
+
+extern "C" void DestroyHelper(BasicHelper* helper) { delete helper; }
+
+#endif
@@ -1,5 +1,19 @@
 #include "ExampleHelper.hh"
 
+void ExampleHelper::InitSlot(unsigned int slot)
+{
+   // addback of the cross crystals, assuming 0-3 are the crystals of the first clover, 4-7 the second clover and so on
+   // (a different geometry can be set with a vector of the clover of each crystal), using only neighbouring crystals within 50 ns
+   fAddback.emplace_back(16, 4);
+   fAddback.back().SquareNeighbours();
+   fAddback.back().TimeGate(50.);
+   fCrossEnergy.emplace_back();
+   fCrossTime.emplace_back();
+
+   // coincidences within +- 100 ns (prompt) and 500-1000 ns (random)
+   fCoincidences[slot].Windows(100., 500., 1000.);
+}
+
 void ExampleHelper::CreateHistograms(unsigned int slot)
 {
    // some variables to easily change range and binning for multiple histograms at once
@@ -13,122 +27,117 @@ void ExampleHelper::CreateHistograms(unsigned int slot)
    fH1[slot]["miscE"]  = new TH1F("miscE", Form("Misc energy;energy [keV];counts/%.1f keV", (highEnergy - lowEnergy) / energyBins), energyBins, lowEnergy, highEnergy);
    fH1[slot]["cebrCh"] = new TH1F("cebrCh", Form("CeBr channel;channel;counts/%.1f channel", (highEnergy - lowEnergy) / energyBins), energyBins, lowEnergy, highEnergy);
 
+   // addback of the cross crystals (see InitSlot)
    fH1[slot]["crossAddbackE"] = new TH1F("crossAddbackE", Form("Cross energy using addback;energy [keV];counts/%.1f keV", (highEnergy - lowEnergy) / energyBins), energyBins, lowEnergy, highEnergy);
 
    // timing spectra
    fH2[slot]["crossT"] = new TH2F("crossT", "Cross ID vs timinig relative to Cross_{0};time [ns];Cross ID", 1000, -2000., 2000., 15, 0.5, 15.5);
 
+   // coincidences between all clover crystals (cross and back, see InitSlot)
+   // the matrices and cubes are symmetric, so only half (a sixth) of them is stored and filled, they are written as TH2F (TH3F)
+   fGG[slot]["ggPrompt"] = new SymmetricMatrix("ggPrompt", "Prompt #gamma#gamma matrix;energy [keV];energy [keV]", 2000, lowEnergy, highEnergy);
+   fGG[slot]["ggRandom"] = new SymmetricMatrix("ggRandom", "Random #gamma#gamma matrix;energy [keV];energy [keV]", 2000, lowEnergy, highEnergy);
+   // a cube is not created by default, as every slot has its own (500 bins are 84 MB per slot, and 0.5 GB as TH3F on output),
+   // if it's created here it also needs to be filled in Process
+   // fGGG[slot]["gggPrompt"] = new SymmetricCube("gggPrompt", "Prompt #gamma#gamma#gamma cube;energy [keV];energy [keV];energy [keV]", 500, lowEnergy, highEnergy);
+   fH1[slot]["ggDeltaT"] = new TH1F("ggDeltaT", "Time difference of clover pairs;#Deltat [ns];counts/ns", 2000, -1000., 1000.);
+
    // hit pattern spectrum
-   fH2[slot]["hp"] = new TH2F("hp", "Hit pattern (cross = 0-15, back = 16-31, misc = 32-47, cebr = 48-63)", 64, -0.5, 63.5, 64, -0.5, 63.5);
+   fGG[slot]["hp"] = new SymmetricMatrix("hp", "Hit pattern (cross = 0-15, back = 16-31, misc = 32-47, cebr = 48-63)", 64, -0.5, 63.5);
 }
 
-// TODO: Change the function arguments to match the detectors you want to use and the declaration in the header file!
-void ExampleHelper::Exec(unsigned int slot, ROOT::RVecD& crossAmplitude, ROOT::RVecD& crossChannelTime, ROOT::RVecD& crossModuleTS, ROOT::RVecD& crossPileup, ROOT::RVecD& crossTriggerTime, ROOT::RVecD& extendedTS, ROOT::RVecD& backAmplitude, ROOT::RVecD& backChannelTime, ROOT::RVecD& backModuleTS, ROOT::RVecD& backPileup, ROOT::RVecD& backTriggerTime, ROOT::RVecD& miscAmplitude, ROOT::RVecD& miscChannelTime, ROOT::RVecD& miscModuleTS, ROOT::RVecD& miscPileup, ROOT::RVecD& miscTriggerTime, ROOT::RVecD& cebrChannelTime, ROOT::RVecD& cebrIntLong, ROOT::RVecD& cebrModuleTS, ROOT::RVecD& cebrTriggerTime)
+void ExampleHelper::Process(unsigned int slot, const View& event)
 {
-   // we use .at() here instead of [] so that we get meaningful error message if a histogram we try to fill wasn't created
-   // e.g. because of a typo
+   // histograms filled for every hit use handles (resolved once in the constructor, a typo in the key throws there),
+   // the others use .at() instead of [] so that we get meaningful error message if a histogram we try to fill wasn't created
 
    // using size of amplitude vectors for all other detectors of the same type
+   using namespace ExampleColumns;
+   const auto& crossAmplitude   = event.Get<CrossAmplitude>();
+   const auto& crossChannelTime = event.Get<CrossChannelTime>();
+   const auto& backAmplitude    = event.Get<BackAmplitude>();
+   const auto& backChannelTime  = event.Get<BackChannelTime>();
 
-   // cross detectors
-   for(size_t i = 0; i < crossAmplitude.size(); ++i) {
-      try {
-         fH1[slot].at("crossE")->Fill(fCalibration->Energy(crossAmplitude[i], i));
-      } catch(std::exception& e) {
-         std::cout << "Failed to fill histogram for cross channel " << i << " (amplitude " << crossAmplitude[i] << "): " << e.what() << std::endl;
-      }
-      if(i > 0) {
-         fH2[slot].at("crossT")->Fill(fCalibration->Time(crossAmplitude[i]) - fCalibration->Time(crossAmplitude[0]), i);
-      }
-   }
+   // the profiling sections are only timed if the helper is compiled with --profile
+   HIGS_PROFILE(slot, "Exec");
 
-   // back detectors
-   for(size_t i = 0; i < backAmplitude.size(); ++i) {
-      fH1[slot].at("backE")->Fill(fCalibration->Energy(backAmplitude[i], i + 16));
+   // all valid hits of this event (built only once per event, even if more than one helper uses them)
+   // using the global ids cross = 0-15, back = 16-31, misc = 32-47, cebr = 48-63 (cebr is not calibrated)
+   auto& hits = HitEvent::ForSlot(slot, fCalibration, "cross+back+misc+cebr");
+   if(hits.Begin(event.Get<Entry>())) {
+      HIGS_PROFILE(slot, "hit event");
+      hits.Add(0, 0, crossAmplitude, crossChannelTime, fCalibration);
+      hits.Add(1, 16, backAmplitude, backChannelTime, fCalibration);
+      hits.Add(2, 32, event.Get<MiscAmplitude>(), event.Get<MiscChannelTime>(), fCalibration);
+      hits.Add(3, 48, event.Get<CebrIntLong>(), event.Get<CebrChannelTime>(), nullptr);
    }
 
-   // misc detectors
-   for(size_t i = 0; i < miscAmplitude.size(); ++i) {
-      fH1[slot].at("miscE")->Fill(fCalibration->Energy(miscAmplitude[i], i + 32));
-   }
-
-   // cebr detectors
-   for(size_t i = 0; i < cebrIntLong.size(); ++i) {
-      fH1[slot].at("cebrCh")->Fill(cebrIntLong[i]);
-   }
-
-   // addbackl
-   double addback = 0.;
-   for(size_t i = 0; i < crossAmplitude.size(); ++i) {
-      if(!std::isnan(crossAmplitude[i])) {
-         addback += fCalibration->Energy(crossAmplitude[i], i);
-      }
-      // check if this index is the last crystal of a detector
-      // assuming 0-3 are the crystals of the first detector, 4-7 the second detector and so on?
-      if(i % 4 == 3 && addback > 0.) {
-         fH1[slot].at("crossAddbackE")->Fill(addback);
-         addback = 0.;
+   {
+      HIGS_PROFILE(slot, "singles");
+      // cross detectors
+      for(size_t i = 0; i < crossAmplitude.size(); ++i) {
+         H1(slot, fCrossE)->Fill(fCalibration->Energy(crossAmplitude[i], i));
+         if(i > 0) {
+            H2(slot, fCrossT)->Fill(fCalibration->Time(crossAmplitude[i]) - fCalibration->Time(crossAmplitude[0]), i);
+         }
       }
-   }
 
-   // hit pattern (with check that amplitudes are not NaN)
-   // meed all combinations of detector type
-   for(size_t i = 0; i < crossAmplitude.size(); ++i) {
-      if(std::isnan(crossAmplitude[i])) { continue; }
-      for(size_t j = 0; j < crossAmplitude.size(); ++j) {
-         if(i == j || std::isnan(crossAmplitude[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i, j);
-      }
-      for(size_t j = 0; j < backAmplitude.size(); ++j) {
-         if(std::isnan(backAmplitude[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i, j + 16);
-         fH2[slot].at("hp")->Fill(j + 16, i);
-      }
-      for(size_t j = 0; j < miscAmplitude.size(); ++j) {
-         if(std::isnan(miscAmplitude[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i, j + 32);
-         fH2[slot].at("hp")->Fill(j + 32, i);
-      }
-      for(size_t j = 0; j < cebrIntLong.size(); ++j) {
-         if(std::isnan(cebrIntLong[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i, j + 48);
-         fH2[slot].at("hp")->Fill(j + 48, i);
+      // back, misc, and cebr detectors
+      const std::array<const char*, 3> names = {"backE", "miscE", "cebrCh"};
+      for(uint8_t type = 1; type < 4; ++type) {
+         auto* hist  = fH1[slot].at(names[type - 1]);
+         auto  range = hits.Range(type);
+         for(size_t hit = range.first; hit < range.second; ++hit) {
+            hist->Fill(hits.Energy(hit));
+         }
       }
    }
-   for(size_t i = 0; i < backAmplitude.size(); ++i) {
-      if(std::isnan(backAmplitude[i])) { continue; }
-      for(size_t j = 0; j < backAmplitude.size(); ++j) {
-         if(i == j || std::isnan(backAmplitude[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i + 16, j + 16);
+
+   {
+      HIGS_PROFILE(slot, "addback");
+      // calibrate all crystals (NaN stays NaN) and let the addback kernel sum up the crystals of each clover
+      // the amplitude and time vectors should have the same size, but we don't rely on it
+      if(crossAmplitude.size() != crossChannelTime.size()) {
+         HIGS_LOG(slot, "Entry " << event.Get<Entry>() << ": " << crossAmplitude.size() << " cross amplitudes, but " << crossChannelTime.size() << " times, only using the first " << std::min(crossAmplitude.size(), crossChannelTime.size()));
       }
-      for(size_t j = 0; j < miscAmplitude.size(); ++j) {
-         if(std::isnan(miscAmplitude[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i + 16, j + 32);
-         fH2[slot].at("hp")->Fill(j + 32, i + 16);
+      const size_t crystals = std::min(crossAmplitude.size(), crossChannelTime.size());
+      auto&        energies = fCrossEnergy[slot];
+      auto&        times    = fCrossTime[slot];
+      energies.resize(crystals);
+      times.resize(crystals);
+      for(size_t i = 0; i < crystals; ++i) {
+         energies[i] = std::isnan(crossAmplitude[i]) ? NAN : fCalibration->Energy(crossAmplitude[i], i);
+         times[i]    = fCalibration->Time(crossChannelTime[i]);
       }
-      for(size_t j = 0; j < cebrIntLong.size(); ++j) {
-         if(std::isnan(cebrIntLong[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i + 16, j + 48);
-         fH2[slot].at("hp")->Fill(j + 48, i + 16);
+      auto& addback = fAddback[slot];
+      addback.Process(energies, times);
+      for(size_t hit = 0; hit < addback.Size(); ++hit) {
+         fH1[slot].at("crossAddbackE")->Fill(addback.Energy(hit));
       }
    }
-   for(size_t i = 0; i < miscAmplitude.size(); ++i) {
-      if(std::isnan(miscAmplitude[i])) { continue; }
-      for(size_t j = 0; j < miscAmplitude.size(); ++j) {
-         if(i == j || std::isnan(miscAmplitude[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i + 32, j + 32);
-      }
-      for(size_t j = 0; j < cebrIntLong.size(); ++j) {
-         if(std::isnan(cebrIntLong[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i + 32, j + 48);
-         fH2[slot].at("hp")->Fill(j + 48, i + 32);
+
+   {
+      HIGS_PROFILE(slot, "coincidences");
+      // collect all clover hits (cross and back are the first hits of the hit event), sort them by time, and sweep through them to find pairs (detector type 0 = cross, 1 = back)
+      auto& coincidences = fCoincidences[slot];
+      coincidences.Clear();
+      for(size_t hit = 0; hit < hits.Range(1).second; ++hit) {
+         coincidences.Add(hits.Type(hit), hits.Id(hit), hits.Energy(hit), hits.Time(hit));
       }
+      coincidences.Sort();
+      coincidences.FillMatrices(fGG[slot].at("ggPrompt"), fGG[slot].at("ggRandom"));
+      // coincidences.FillCubes(fGGG[slot].at("gggPrompt"), nullptr);
+      coincidences.FillTimeDifference(fH1[slot].at("ggDeltaT"));
    }
-   for(size_t i = 0; i < cebrIntLong.size(); ++i) {
-      if(std::isnan(cebrIntLong[i])) { continue; }
-      for(size_t j = 0; j < cebrIntLong.size(); ++j) {
-         if(i == j || std::isnan(cebrIntLong[j])) { continue; }
-         fH2[slot].at("hp")->Fill(i + 48, j + 48);
+
+   {
+      HIGS_PROFILE(slot, "hit pattern");
+      // all pairs of valid hits (so NaN amplitudes have already been removed), each pair only once as the matrix is symmetric
+      auto* hitPattern = fGG[slot].at("hp");
+      for(size_t i = 0; i < hits.Size(); ++i) {
+         for(size_t j = i + 1; j < hits.Size(); ++j) {
+            hitPattern->Fill(hits.Id(i), hits.Id(j));
+         }
       }
    }
 }
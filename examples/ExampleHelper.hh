@@ -2,40 +2,61 @@
 #ifndef EXAMPLEHELPER_HH
 #define EXAMPLEHELPER_HH
 
-#include "BasicHelper.h"
+#include "ColumnHelper.h"
+#include "Addback.h"
 
 // This is a custom action which respects a well defined interface. It supports parallelism,
 // in the sense that it behaves correctly if implicit multi threading is enabled.
 // Note the plural: in presence of a MT execution, internally more than a single TList is created.
-// The detector types in the specifcation of Book must match those in the call to it as well as those in the Exec function (and be in the same order)!
 
-class ExampleHelper : public BasicHelper, public ROOT::Detail::RDF::RActionImpl<ExampleHelper> {
+// TODO: edit the columns to match the detectors you want to use!
+// Each column is declared with the name of the branch and the type it is stored as (vectors of this type are read as ROOT::RVec),
+// only columns listed in the ColumnHelper below are read, so there is no need to list columns that aren't used.
+namespace ExampleColumns {
+HIGS_COLUMN(CrossAmplitude, "clover_cross.amplitude", double);
+HIGS_COLUMN(CrossChannelTime, "clover_cross.channel_time", double);
+HIGS_COLUMN(BackAmplitude, "clover_back.amplitude", double);
+HIGS_COLUMN(BackChannelTime, "clover_back.channel_time", double);
+HIGS_COLUMN(MiscAmplitude, "misc.amplitude", double);
+HIGS_COLUMN(MiscChannelTime, "misc.channel_time", double);
+HIGS_COLUMN(CebrIntLong, "cebr_all.integration_long", double);
+HIGS_COLUMN(CebrChannelTime, "cebr_all.channel_time", double);
+HIGS_SCALAR_COLUMN(Entry, "rdfentry_", ULong64_t);   // entry number, used to build the hit event only once per event
+}   // namespace ExampleColumns
+
+class ExampleHelper : public ColumnHelper<ExampleHelper, ExampleColumns::CrossAmplitude, ExampleColumns::CrossChannelTime, ExampleColumns::BackAmplitude, ExampleColumns::BackChannelTime, ExampleColumns::MiscAmplitude, ExampleColumns::MiscChannelTime, ExampleColumns::CebrIntLong, ExampleColumns::CebrChannelTime, ExampleColumns::Entry> {
 public:
    // constructor sets the prefix (which is used for the output file as well)
    // and calls Setup which in turn also calls CreateHistograms
+   // with lazy slots the histograms are only created once, and cloned for each slot that is actually used
    explicit ExampleHelper(TList* list)
-      : BasicHelper(list)
+      : ColumnHelper(list)
    {
       Prefix("ExampleHelper");
+      LazySlots(true);
       Setup();
+      // handles of the histograms filled for every hit, so Process doesn't need to look up their keys
+      fCrossE = H1Handle("crossE");
+      fCrossT = H2Handle("crossT");
    }
 
-   ROOT::RDF::RResultPtr<std::map<std::string, TList>> Book(ROOT::RDataFrame* d) override
-   {
-      // TODO: edit the template specification and branch names to match the detectors you want to use!
-      return d->Book<ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD, ROOT::RVecD>(std::move(*this), {"clover_cross.amplitude", "clover_cross.channel_time", "clover_cross.module_timestamp", "clover_cross.pileup", "clover_cross.trigger_time", "extended_timestamp", "clover_back.amplitude", "clover_back.channel_time", "clover_back.module_timestamp", "clover_back.pileup", "clover_back.trigger_time", "misc.amplitude", "misc.channel_time", "misc.module_timestamp", "misc.pileup", "misc.trigger_time", "cebr_all.channel_time", "cebr_all.integration_long", "cebr_all.module_timestamp", "cebr_all.trigger_time"});
-   }
-   // this function creates and books all histograms
+   // this function sets up everything each slot needs besides the histograms (called for every slot in order)
+   void InitSlot(unsigned int slot) override;
+   // this function creates and books all histograms (with lazy slots only for the prototype)
    void CreateHistograms(unsigned int slot) override;
-   // this function gets called for every single event and fills the histograms
-   // TODO: edit the function arguments to match the detectors you want to use!
-   void Exec(unsigned int slot, ROOT::RVecD& crossAmplitude, ROOT::RVecD& crossChannelTime, ROOT::RVecD& crossModuleTS, ROOT::RVecD& crossPileup, ROOT::RVecD& crossTriggerTime, ROOT::RVecD& extendedTS, ROOT::RVecD& backAmplitude, ROOT::RVecD& backChannelTime, ROOT::RVecD& backModuleTS, ROOT::RVecD& backPileup, ROOT::RVecD& backTriggerTime, ROOT::RVecD& miscAmplitude, ROOT::RVecD& miscChannelTime, ROOT::RVecD& miscModuleTS, ROOT::RVecD& miscPileup, ROOT::RVecD& miscTriggerTime, ROOT::RVecD& cebrChannelTime, ROOT::RVecD& cebrIntLong, ROOT::RVecD& cebrModuleTS, ROOT::RVecD& cebrTriggerTime);
+   // this function gets called for every single event and fills the histograms, the columns are accessed via their tags
+   void Process(unsigned int slot, const View& event);
    // this function is optional and is called after the output lists off all slots/workers have been merged
    void EndOfSort(std::shared_ptr<std::map<std::string, TList>>& list) override;
 
 private:
-   // any constants that are set in the CreateHistograms function and used in the Exec function can be stored here
+   // any constants that are set in the CreateHistograms function and used in the Process function can be stored here
    // or any other settings
+   std::vector<Addback>     fAddback;       // one addback per slot
+   std::vector<ROOT::RVecD> fCrossEnergy;   // calibrated cross energies (one buffer per slot)
+   std::vector<ROOT::RVecD> fCrossTime;     // calibrated cross times (one buffer per slot)
+   HistogramHandle<TH1>     fCrossE;        // cross energy spectrum
+   HistogramHandle<TH2>     fCrossT;        // cross ID vs time
 };
 
 // These are needed functions used by TDataFrameLibrary to create and destroy the instance of this helper
@@ -0,0 +1,95 @@
+#ifndef ADDBACK_H
+#define ADDBACK_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "ROOT/RVec.hxx"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class Addback
+///
+/// Addback of clover crystals. The mapping of crystals to
+/// clovers (and the position of the crystal within the clover)
+/// is calculated once when the geometry is set, so processing
+/// an event needs no modulo arithmetic. Each event is processed
+/// in two passes: the first one turns the calibrated energies
+/// into one bit mask of hit crystals per clover (and sums the
+/// energies if no neighbour or time condition is used), the
+/// second one builds the addback hits from these masks.
+///
+/// By default all crystals of a clover are added up. With
+/// neighbour-only addback only crystals that are neighbours
+/// (directly or via other hit crystals) are added, so a clover
+/// can have more than one addback hit. With a time gate only
+/// crystals within the gate of the crystal with the highest
+/// energy are added. Crystals that aren't added become their
+/// own addback hit.
+///
+/// \code
+/// Addback addback(16, 4);   // 16 crystals, 4 crystals per clover
+/// addback.SquareNeighbours();   // crystals 0-1-2-3 in a square
+/// addback.TimeGate(50.);
+/// addback.Process(energies, times);
+/// for(size_t hit = 0; hit < addback.Size(); ++hit) { addback.Energy(hit); }
+/// \endcode
+///
+/////////////////////////////////////////////////////////////////
+
+class Addback {
+public:
+   /// Consecutive groups of crystalsPerClover crystals form one clover.
+   explicit Addback(size_t crystals = 16, size_t crystalsPerClover = 4);
+   /// The clover of each crystal is given explicitly (at most 32 crystals per clover).
+   explicit Addback(const std::vector<size_t>& clover);
+
+   /// Sets the neighbours of a crystal (crystal numbers, not the position within the clover), and switches on
+   /// neighbour-only addback. Neighbours in other clovers are ignored.
+   void Neighbours(size_t crystal, const std::vector<size_t>& neighbours);
+   /// Sets the neighbours for clovers of 4 crystals arranged in a square (0-1-2-3-0), so diagonal crystals aren't
+   /// neighbours.
+   void SquareNeighbours();
+   void NeighboursOnly(bool val) { fNeighboursOnly = val; }
+   /// Only adds crystals with a time within the gate of the crystal with the highest energy, a gate <= 0 turns it off.
+   void TimeGate(double gate) { fTimeGate = gate; }
+   /// Crystals with an energy below the threshold are ignored.
+   void Threshold(double threshold) { fThreshold = threshold; }
+
+   /// Calculates the addback hits from the calibrated energies (NaN = no hit) and times of all crystals.
+   /// The times are only used if a time gate is set.
+   void Process(const ROOT::RVecD& energy, const ROOT::RVecD& time = {});
+
+   size_t Clovers() const { return fCloverCrystals.size(); }
+   size_t Size() const { return fEnergy.size(); }
+   /// Energy, time (of the crystal with the highest energy), clover, and number of crystals of each addback hit.
+   double  Energy(size_t hit) const { return fEnergy[hit]; }
+   double  Time(size_t hit) const { return fTime[hit]; }
+   size_t  Clover(size_t hit) const { return fClover[hit]; }
+   uint8_t Multiplicity(size_t hit) const { return fMultiplicity[hit]; }
+
+   const std::vector<double>& Energies() const { return fEnergy; }
+
+private:
+   void SetGeometry(const std::vector<size_t>& clover);
+
+   // geometry, calculated once
+   std::vector<uint16_t>            fCrystalClover;    ///< clover of each crystal
+   std::vector<uint8_t>             fCrystalBit;       ///< position of each crystal within its clover
+   std::vector<std::vector<size_t>> fCloverCrystals;   ///< crystals of each clover
+   std::vector<uint32_t>            fNeighbourMask;    ///< neighbours of each crystal as bit mask of positions within the clover
+   bool                             fNeighboursOnly{false};
+   double                           fTimeGate{0.};
+   double                           fThreshold{0.};
+
+   // per event (kept to avoid allocations)
+   std::vector<uint32_t> fHitMask;
+   std::vector<double>   fCloverSum;
+   std::vector<double>   fEnergy;
+   std::vector<double>   fTime;
+   std::vector<size_t>   fClover;
+   std::vector<uint8_t>  fMultiplicity;
+};
+
+#endif
@@ -4,8 +4,10 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "TList.h"
+#include "TChain.h"
 
 #include "ROOT/RDataFrame.hxx"
 #if ROOT_VERSION_CODE >= ROOT_VERSION(6, 24, 0)
@@ -20,15 +22,49 @@ public:
    explicit BasicFrame(Options* opt);
 
    void Run(Redirect*& redirect);
+   /// Keeps watching the input directories for new files and processes all data not processed yet, until interrupted.
+   void Follow(Redirect*& redirect);
+
+   /// Writes all lists of the output map into their directories of the current file, optionally merging them with the objects already in the file.
+   static void WriteOutput(std::map<std::string, TList>& output, bool merge = false);
 
 private:
+   void Book(const std::vector<std::string>& files);
+   /// Estimates the memory needed for the requested number of workers, and applies the memory policy.
+   void PlanMemory();
+   /// Restricts the chain to the entries of the entry list (--entry-list), returns the number of entries selected.
+   Long64_t ApplyEntryList();
+   /// Restricts the chain to the entries within the time range (--time-range) using the zone maps of the files, returns
+   /// the number of entries selected.
+   Long64_t ApplyTimeRange();
+   /// Prints a warning if the chain has fewer clusters than workers.
+   void ReportClusters();
+   /// Adds the cached derived columns of all files as friend of the chain (--derived-cache).
+   void AddDerivedColumns();
+   /// Creates a copy of the chain that reads the local files through memory mappings (--mmap).
+   void MapChain();
+   void ReadLedger();
+   void WriteLedger();
+
    Options*                                            fOptions;
+   std::string                                         fTreeName;
    std::string                                         fOutputPrefix{"default"};
+   std::string                                         fOutputFileName;
+   std::string                                         fLedgerFileName;
    ROOT::RDF::RResultPtr<std::map<std::string, TList>> fOutput;
+   TList*                                              fInputList{nullptr};
 
+   TChain*           fChain{nullptr};
+   TChain*           fFriend{nullptr};   ///< derived columns of all files of the chain (--derived-cache only)
+   TChain*           fMapped{nullptr};   ///< copy of the chain reading the files through memory mappings (--mmap only)
    ROOT::RDataFrame* fDataFrame{nullptr};
    Long64_t          fTotalEntries{0};
 
+   std::vector<std::string>        fFiles;       ///< all input files (grows in follow mode)
+   std::map<std::string, Long64_t> fProcessed;   ///< number of entries already processed for each file (follow mode only)
+   std::map<std::string, Long64_t> fPending;     ///< number of entries each file will have been processed up to once the current pass is written
+   bool                            fMerge{false};   ///< merge the output with the existing output file instead of overwriting it
+
 #if ROOT_VERSION_CODE >= ROOT_VERSION(6, 24, 0)
 #if ROOT_VERSION_CODE >= ROOT_VERSION(6, 36, 0)
     ROOT::RLogScopedVerbosity* fVerbosity{nullptr};
@@ -1,5 +1,7 @@
 #ifndef TGRSIHELPER_H
 #define TGRSIHELPER_H
+#include <cassert>
+
 #include "RVersion.h"
 #include "ROOT/RDataFrame.hxx"
 #include "TObject.h"
@@ -14,6 +16,16 @@
 #include "Calibration.h"
 #include "Options.h"
 #include "CustomMap.h"
+#include "Profiler.h"
+#include "Logger.h"
+#include "Coincidences.h"
+#include "HitEvent.h"
+#include "Gate.h"
+#include "SymmetricMatrix.h"
+#include "SymmetricCube.h"
+#include "Monitor.h"
+#include "HistogramDefinitions.h"
+#include "HistogramHandle.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 ///
@@ -22,6 +34,8 @@
 /// Base class for all helpers used in HigsFrame.
 /// It provides some general members that are set from the input list.
 /// It also loads settings from the input list.
+/// Slot 0 is created in Setup, all other slots once the number of slots
+/// of the data frame is known (see Slots and LazySlots).
 ///
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -34,15 +48,75 @@ protected:
    std::vector<CustomMap<std::string, TH1*>>                  fH1;                      // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one map per data processing slot for 1D histograms
    std::vector<CustomMap<std::string, TH2*>>                  fH2;                      // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one map per data processing slot for 2D histograms
    std::vector<CustomMap<std::string, TH3*>>                  fH3;                      // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one map per data processing slot for 3D histograms
+   std::vector<CustomMap<std::string, SymmetricMatrix*>>      fGG;                      // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one map per data processing slot for symmetric matrices (written as TH2F)
+   std::vector<CustomMap<std::string, SymmetricCube*>>        fGGG;                     // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one map per data processing slot for symmetric cubes (written as TH3F if small enough)
    std::vector<CustomMap<std::string, TTree*>>                fTree;                    // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one map per data processing slot for trees
    std::vector<CustomMap<std::string, TObject*>>              fObject;                  // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one map per data processing slot for any TObjects
+   std::vector<Coincidences>                                  fCoincidences;            // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! one coincidence buffer per data processing slot
    std::map<std::string, TCutG*>                              fCuts;                    // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! map of cuts
+   std::map<std::string, Gate>                                fGates;                   // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! fast versions of the cuts (same keys), created at the end of Setup
    Calibration*                                               fCalibration{nullptr};    // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! calibration
    std::string                                                fPrefix{"BasicHelper"};   // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes) //!<! name of this action (used as prefix)
 
+   /// Checks the size of all objects in the output list of this slot, histograms that are too large to be written are replaced by a TiledHistogram, all other objects are removed.
+   void CheckSizes(unsigned int slot, const char* usage);
+   /// Replaces the symmetric matrices and cubes in the output list with their expanded TH2F and TH3F versions.
+   void ExpandSymmetric(std::map<std::string, TList>& lists);
+
 private:
+   /// Adds all objects of the slot to its output lists.
+   void FillLists(unsigned int slot);
+   /// Creates the objects of the slot by cloning the prototype.
+   void CloneSlot(unsigned int slot);
+   /// Deletes the objects of the prototype (lazy slots only), called in Finalize once no more slots are cloned.
+   void DeletePrototype();
+   /// Creates the objects of the slot: the ones of CreateHistograms and the defined histograms (--histograms).
+   void CreateSlot(unsigned int slot);
+   /// Position of the key in the map of the prototype (or slot 0), throws if the key doesn't exist.
+   template <typename Map>
+   size_t Resolve(const Map& map, const std::string& key) const;
+   /// Histogram at the position of the handle, only checked without NDEBUG since this is called for every fill.
+   template <typename Map, typename T>
+   T* At(const Map& map, const HistogramHandle<T>& handle) const
+   {
+      assert(handle.Index() < map.size() && (map.begin() + handle.Index())->first == handle.Key() && "histogram handle doesn't match the histograms of this slot");
+      return (map.begin() + handle.Index())->second;
+   }
+   /// Creates the objects of the slots [first, last) in parallel, each on a thread pinned to the node of the slot (--numa without lazy slots).
+   void CreateOnNodes(unsigned int first, unsigned int last);
+
+   /// Merges the selected entries of all slots and writes them as entry list.
+   void WriteSelection();
+   /// Histograms of all slots that have been created (called from the thread of the monitor).
+   Monitor::Histograms MonitoredHistograms();
+
+   /// Entries selected by one slot, with the file of the current entry cached until the task or file changes.
+   struct Selection {
+      TTreeReader*                                 fReader{nullptr};
+      int                                          fTreeNumber{-1};
+      std::vector<Long64_t>*                       fEntries{nullptr};   ///< entries of the current file
+      std::string                                  fTreeName;
+      std::map<std::string, std::vector<Long64_t>> fFiles;              ///< selected entries of each file
+   };
+
    static constexpr int fSizeLimit = 1073741822;   //!<! 1 GiB size limit for objects in ROOT
-   void                 CheckSizes(unsigned int slot, const char* usage);
+
+   bool                                     fLazySlots{false};       //!<! create slots by cloning the prototype on first use
+   bool                                     fAddDirectory{true};     //!<! TH1::AddDirectoryStatus() before the event loop
+   bool                                     fPinThreads{false};      //!<! pin the thread of each task to the core of its slot (--numa)
+   bool                                     fSelectEntries{false};   //!<! write the entries selected with Select as entry list
+   bool                                     fBatches{false};         //!<! events are processed in batches, so Select doesn't know the entry
+   std::vector<Selection>                   fSelections;             //!<! entries selected by each slot
+   std::unique_ptr<Monitor>                 fMonitor;                //!<! writes snapshots of the histograms during the event loop (--monitor)
+   std::unique_ptr<HistogramDefinitions>    fDefinitions;            //!<! histograms declared in a file (--histograms)
+   std::vector<char>                        fCreated;                //!<! whether the objects of each slot have been created
+   std::map<std::string, TList>             fPrototypeLists;         //!<! output lists of the prototype (lazy slots only)
+   CustomMap<std::string, TH1*>             fPrototypeH1;            //!<! prototype of the 1D histograms (lazy slots only)
+   CustomMap<std::string, TH2*>             fPrototypeH2;            //!<! prototype of the 2D histograms (lazy slots only)
+   CustomMap<std::string, TH3*>             fPrototypeH3;            //!<! prototype of the 3D histograms (lazy slots only)
+   CustomMap<std::string, SymmetricMatrix*> fPrototypeGG;            //!<! prototype of the symmetric matrices (lazy slots only)
+   CustomMap<std::string, SymmetricCube*>   fPrototypeGGG;           //!<! prototype of the symmetric cubes (lazy slots only)
+   CustomMap<std::string, TObject*>         fPrototypeObject;        //!<! prototype of the other objects (lazy slots only)
 
 public:
    /// This type is a requirement for every helper.
@@ -50,15 +124,36 @@ public:
 
    explicit BasicHelper(TList* input);
 
+   /// Largest object ROOT can write (in bytes).
+   static constexpr int SizeLimit() { return fSizeLimit; }
+
    /// This function builds the vectors of TLists and maps for 1D- and 2D-histograms.
    /// It calls the overloaded CreateHistograms functions in which the user can define
    /// their histograms. Then it adds all those histograms to the list of the corresponding slot.
    virtual void Setup();
+   /// Creates the remaining slots (called by Initialize with the number of slots of the data frame). With --numa the
+   /// slots are created in parallel, each by a thread on the NUMA node of its slot.
+   void Slots(unsigned int nSlots);
+   /// Virtual helper function that is called for every slot in order, before any histograms of the slot are created.
+   /// It can be used to set up per-slot state of the helper (and has to be used for that with lazy slots).
+   virtual void InitSlot(unsigned int) {}
    /// Virtual helper function that the user uses to create their histograms
    virtual void CreateHistograms(unsigned int)
    {
+      // helpers can use only histograms declared in a file
+      if(fDefinitions != nullptr) { return; }
       std::cout << this << " - " << __PRETTY_FUNCTION__ << ", " << Prefix() << ": This function should not get called, the user's code should replace it. Not creating any histograms!" << std::endl;   // NOLINT(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
    }
+
+   /// Handles of histograms created by CreateHistograms or declared in the file (call after Setup), throw if the key doesn't exist.
+   HistogramHandle<TH1> H1Handle(const std::string& key) const;
+   HistogramHandle<TH2> H2Handle(const std::string& key) const;
+   HistogramHandle<TH3> H3Handle(const std::string& key) const;
+   /// Histogram of the slot the handle refers to.
+   TH1* H1(unsigned int slot, const HistogramHandle<TH1>& handle) const { return At(fH1[slot], handle); }
+   TH2* H2(unsigned int slot, const HistogramHandle<TH2>& handle) const { return At(fH2[slot], handle); }
+   TH3* H3(unsigned int slot, const HistogramHandle<TH3>& handle) const { return At(fH3[slot], handle); }
+
    /// This method will call the Book action on the provided dataframe
    virtual ROOT::RDF::RResultPtr<std::map<std::string, TList>> Book(ROOT::RDataFrame*)
    {
@@ -72,8 +167,32 @@ public:
    BasicHelper& operator=(BasicHelper&&)      = default;
    ~BasicHelper()                             = default;
    std::shared_ptr<std::map<std::string, TList>> GetResultPtr() const { return fLists[0]; }
-   void                                          InitTask(TTreeReader*, unsigned int) {}
-   void                                          Initialize() {}   // required method, gets called once before starting the event loop
+   /// Required method, gets called at the start of each task of a slot, pins the thread to the core of the slot (with
+   /// --numa) and creates the slot if it hasn't been used yet.
+   void InitTask(TTreeReader*, unsigned int slot);
+   /// Required method, gets called once before starting the event loop, creates the slots and starts the monitor
+   /// (--monitor), which writes merged snapshots of the histograms to <prefix><run>.snapshot.root.
+   void Initialize();
+
+   /// Selects the current entry of the slot for the entry list (only used if SelectEntries(true) was called in the
+   /// constructor). The entries are written to <prefix><run>.entries.root at the end of Finalize, for --entry-list.
+   /// Batch helpers can't use it, as the reader is at the last event of the batch when ExecBatch is called.
+   void Select(unsigned int slot);
+   bool SelectEntries() const { return fSelectEntries; }
+   void SelectEntries(bool val) { fSelectEntries = val; }
+   /// Name of the entry list in the file written by WriteSelection.
+   static constexpr const char* kEntryListName = "entries";
+
+   /// With lazy slots (set before Setup) the objects of CreateHistograms(0) are kept as prototype, and each slot is
+   /// cloned from it in InitTask the first time it's used, so unused slots cost nothing. Any other per-slot state, and
+   /// trees, need to be created in InitSlot then.
+   bool LazySlots() const { return fLazySlots; }
+   void LazySlots(bool val) { fLazySlots = val; }
+   /// Whether the events are processed in batches (set by BatchHelper).
+   bool Batches() const { return fBatches; }
+   void Batches(bool val) { fBatches = val; }
+   /// Output lists of one slot before it's used (the prototype for lazy slots, slot 0 otherwise).
+   std::map<std::string, TList>& Prototype() { return fLazySlots ? fPrototypeLists : *fLists[0]; }
    /// This required method is called at the end of the event loop. It is used to merge all the internal TLists which
    /// were used in each of the data processing slots.
    void Finalize();
@@ -0,0 +1,194 @@
+#ifndef BATCHHELPER_H
+#define BATCHHELPER_H
+
+#include <tuple>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "ROOT/RVec.hxx"
+
+#include "ColumnHelper.h"
+
+namespace ColumnDetail {
+/// Buffer of a scalar column, one value per event.
+template <typename T>
+struct Buffer {
+   void Add(const T& value) { fValues.push_back(value); }
+   void Clear() { fValues.clear(); }
+
+   std::vector<T> fValues;
+};
+
+/// Buffer of a vector column, the values of all events are stored one after the other.
+template <typename T>
+struct Buffer<ROOT::RVec<T>> {
+   void Add(const ROOT::RVec<T>& values)
+   {
+      auto event = static_cast<uint32_t>(fOffsets.size() - 1);
+      fValues.insert(fValues.end(), values.begin(), values.end());
+      for(size_t channel = 0; channel < values.size(); ++channel) {
+         fEvents.push_back(event);
+         fChannels.push_back(static_cast<uint16_t>(channel));
+      }
+      fOffsets.push_back(fValues.size());
+   }
+   void Clear()
+   {
+      fValues.clear();
+      fEvents.clear();
+      fChannels.clear();
+      fOffsets.assign(1, 0);
+   }
+
+   std::vector<T>        fValues;
+   std::vector<size_t>   fOffsets{0};   ///< index of the first value of each event, with the total number of values at the end
+   std::vector<uint32_t> fEvents;       ///< event (within the batch) of each value
+   std::vector<uint16_t> fChannels;     ///< index of each value within its event
+};
+}   // namespace ColumnDetail
+
+/// The columns of a batch of consecutive events of one slot, stored as structure of arrays. Scalar columns have one
+/// value per event, the values of vector columns of all events are stored one after the other, so loops over all
+/// values of a batch can be vectorized:
+/// \code
+/// const auto& amplitude = batch.Values<CrossAmplitude>();
+/// const auto& channel   = batch.Channels<CrossAmplitude>();
+/// for(size_t i = 0; i < amplitude.size(); ++i) { energy[i] = offset[channel[i]] + gain[channel[i]] * amplitude[i]; }
+/// \endcode
+template <typename... Columns>
+class ColumnBatch {
+public:
+   /// Number of events in the batch.
+   size_t Size() const { return fSize; }
+
+   /// All values of the column (one per event for scalar columns).
+   template <typename Column>
+   const auto& Values() const
+   {
+      return Get<Column>().fValues;
+   }
+   /// Index of the first value of each event of a vector column, with the total number of values at the end.
+   template <typename Column>
+   const std::vector<size_t>& Offsets() const
+   {
+      return Get<Column>().fOffsets;
+   }
+   /// Event (within the batch) of each value of a vector column.
+   template <typename Column>
+   const std::vector<uint32_t>& Events() const
+   {
+      return Get<Column>().fEvents;
+   }
+   /// Index of each value of a vector column within its event (i.e. the channel).
+   template <typename Column>
+   const std::vector<uint16_t>& Channels() const
+   {
+      return Get<Column>().fChannels;
+   }
+
+   void Add(const typename Columns::type&... columns)
+   {
+      Add(std::index_sequence_for<Columns...>{}, columns...);
+      ++fSize;
+   }
+   void Clear()
+   {
+      Clear(std::index_sequence_for<Columns...>{});
+      fSize = 0;
+   }
+
+private:
+   template <typename Column>
+   const auto& Get() const
+   {
+      return std::get<ColumnDetail::IndexOf<Column, Columns...>::value>(fBuffers);
+   }
+   template <size_t... Indices>
+   void Add(std::index_sequence<Indices...>, const typename Columns::type&... columns)
+   {
+      (std::get<Indices>(fBuffers).Add(columns), ...);
+   }
+   template <size_t... Indices>
+   void Clear(std::index_sequence<Indices...>)
+   {
+      (std::get<Indices>(fBuffers).Clear(), ...);
+   }
+
+   std::tuple<ColumnDetail::Buffer<typename Columns::type>...> fBuffers;
+   size_t                                                     fSize{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \class BatchHelper
+///
+/// Base class for helpers that process batches of events instead of single
+/// events. Each slot gathers BatchSize consecutive events (of that slot)
+/// into a ColumnBatch, and the helper gets them all at once, so calibration,
+/// gating, and binning can be vectorized across events and the overhead per
+/// call is paid once per batch. Derived is the helper itself, which needs to
+/// implement
+/// \code
+/// void ExecBatch(unsigned int slot, const Batch& batch);
+/// \endcode
+/// instead of Process. The last, incomplete batch of each slot is processed
+/// at the start of Finalize. Helpers that need one event at a time (e.g. to
+/// use the HitEvent shared with other helpers) derive from ColumnHelper.
+/// Batch helpers can't select entries (SelectEntries(true)), as the reader
+/// is at the last event of the batch when ExecBatch is called.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Derived, size_t BatchSize, typename... Columns>
+class BatchHelper : public ColumnHelper<Derived, Columns...> {
+public:
+   using Batch = ColumnBatch<Columns...>;
+
+   explicit BatchHelper(TList* input)
+      : ColumnHelper<Derived, Columns...>(input)
+   {
+      this->Batches(true);
+   }
+
+   /// Called by RDataFrame before the event loop, creates one batch per slot.
+   void Initialize()
+   {
+      BasicHelper::Initialize();
+      // one allocation per slot, so the slots don't share cache lines
+      while(fSlotBatches.size() < this->fLists.size()) {
+         fSlotBatches.emplace_back(new Batch);
+      }
+   }
+
+   /// Called by RDataFrame for every event, adds the event to the batch of the slot and processes the batch once it's full.
+   void Exec(unsigned int slot, typename Columns::type&... columns)
+   {
+      auto& batch = *fSlotBatches[slot];
+      batch.Add(columns...);
+      if(batch.Size() >= BatchSize) { Flush(slot); }
+   }
+
+   /// Called by RDataFrame at the end of the event loop, processes the remaining events of all slots before merging.
+   void Finalize()
+   {
+      for(unsigned int slot = 0; slot < fSlotBatches.size(); ++slot) {
+         Flush(slot);
+      }
+      BasicHelper::Finalize();
+   }
+
+private:
+   void Flush(unsigned int slot)
+   {
+      auto& batch = *fSlotBatches[slot];
+      if(batch.Size() == 0) { return; }
+      static_cast<Derived*>(this)->ExecBatch(slot, batch);
+      batch.Clear();
+   }
+
+   std::vector<std::unique_ptr<Batch>> fSlotBatches;   //!<! batch of events of each slot
+};
+
+#endif
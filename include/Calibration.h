@@ -15,6 +15,9 @@ public:
 
    double Timestamp(double channel) const { return fTimestampOffset + fTimestampGain * (channel + gRandom->Uniform(0, 1)); }
 
+   /// Hash of all calibration values, e.g. to tell whether values calibrated before are still valid.
+   ULong64_t Hash() const;
+
    void Print(Option_t* opt = "") const override;
 
 private:
@@ -0,0 +1,181 @@
+#ifndef COINCIDENCES_H
+#define COINCIDENCES_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include "ROOT/RVec.hxx"
+#include "TH1.h"
+#include "TH2.h"
+
+#include "Calibration.h"
+#include "SymmetricMatrix.h"
+#include "SymmetricCube.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class Coincidences
+///
+/// Collects all hits of an event (detector type, index, energy,
+/// and time) in one buffer, sorts them by time, and finds all
+/// pairs or triples of hits within the prompt or random time
+/// window with a sweep over the sorted times. This replaces
+/// nested loops over every combination of detector types.
+///
+/// Each data processing slot has its own buffer (the vector
+/// fCoincidences in BasicHelper), which is cleared but not
+/// freed for each event, so there are no allocations once the
+/// buffer has grown to the largest event. The hits are stored
+/// as structure of arrays, so the sweep runs over contiguous
+/// times.
+///
+/// The windows are in the same units as the calibrated time,
+/// and are applied to the absolute time difference: prompt is
+/// |dt| <= prompt, random is randomLow <= |dt| <= randomHigh.
+/// For triples the time difference between the first and last
+/// hit is used.
+///
+/////////////////////////////////////////////////////////////////
+
+class Coincidences {
+public:
+   enum class EWindow : uint8_t { kPrompt,
+                                  kRandom };
+   /// Detector mask that uses all detector types.
+   static constexpr uint64_t kAllDetectors = ~0ULL;
+
+   explicit Coincidences(double prompt = 100., double randomLow = 500., double randomHigh = 1000.)
+   {
+      Windows(prompt, randomLow, randomHigh);
+   }
+
+   /// Sets the prompt and random windows, the random window can be switched off by setting randomHigh <= randomLow.
+   void Windows(double prompt, double randomLow, double randomHigh)
+   {
+      fPrompt     = prompt;
+      fRandomLow  = randomLow;
+      fRandomHigh = randomHigh;
+      fReach      = (fRandomHigh > fRandomLow ? std::max(fPrompt, fRandomHigh) : fPrompt);
+   }
+   double Prompt() const { return fPrompt; }
+   double RandomLow() const { return fRandomLow; }
+   double RandomHigh() const { return fRandomHigh; }
+
+   /// Clears the buffer for the next event (keeping the memory).
+   void Clear()
+   {
+      fDetector.clear();
+      fIndex.clear();
+      fEnergy.clear();
+      fTime.clear();
+      fSorted = true;
+   }
+
+   /// Adds one hit, hits without a valid time (NaN or infinite) are ignored, as they can't be sorted or paired.
+   void Add(uint8_t detector, uint16_t index, double energy, double time)
+   {
+      if(!std::isfinite(time)) { return; }
+      if(!fTime.empty() && time < fTime.back()) { fSorted = false; }
+      fDetector.push_back(detector);
+      fIndex.push_back(index);
+      fEnergy.push_back(energy);
+      fTime.push_back(time);
+   }
+   /// Adds all channels of one detector type that have an amplitude and a time (i.e. not NaN), calibrating amplitudes
+   /// and times, the energy calibration of channel i uses the id firstId + i.
+   void Add(uint8_t detector, const ROOT::RVecD& amplitude, const ROOT::RVecD& time, const Calibration* calibration, int firstId);
+
+   /// Sorts the hits by time, needs to be called once all hits of the event have been added.
+   void Sort();
+
+   size_t   Size() const { return fTime.size(); }
+   uint8_t  Detector(size_t hit) const { return fDetector[hit]; }
+   uint16_t Index(size_t hit) const { return fIndex[hit]; }
+   double   Energy(size_t hit) const { return fEnergy[hit]; }
+   double   Time(size_t hit) const { return fTime[hit]; }
+
+   /// Calls function(first, second, window) for all pairs of hits within the prompt or random window, first is
+   /// always the earlier hit. The hits have to be sorted.
+   template <typename Function>
+   void ForEachPair(Function&& function) const
+   {
+      const size_t  size = fTime.size();
+      const double* time = fTime.data();
+      for(size_t first = 0; first < size; ++first) {
+         for(size_t second = first + 1; second < size && time[second] - time[first] <= fReach; ++second) {
+            EWindow window{};
+            if(Classify(time[second] - time[first], window)) {
+               function(first, second, window);
+            }
+         }
+      }
+   }
+
+   /// Calls function(first, second, third, window) for all triples of hits within the prompt or random window, in
+   /// order of time. The hits have to be sorted.
+   template <typename Function>
+   void ForEachTriple(Function&& function) const
+   {
+      const size_t  size = fTime.size();
+      const double* time = fTime.data();
+      for(size_t first = 0; first < size; ++first) {
+         for(size_t second = first + 1; second < size && time[second] - time[first] <= fReach; ++second) {
+            for(size_t third = second + 1; third < size && time[third] - time[first] <= fReach; ++third) {
+               EWindow window{};
+               if(Classify(time[third] - time[first], window)) {
+                  function(first, second, third, window);
+               }
+            }
+         }
+      }
+   }
+
+   /// Fills the energies of all pairs into the prompt or random matrix (symmetrized), only pairs where both detector
+   /// types are in the mask (bit n = detector type n) are used. Either histogram can be a nullptr. Detector types of 64
+   /// and above can't be selected by a mask, they are only used with the default mask (all detectors).
+   void FillMatrices(TH2* prompt, TH2* random, uint64_t detectorMask = kAllDetectors) const;
+   /// Same as above, but each pair is filled only once into the symmetric matrices.
+   void FillMatrices(SymmetricMatrix* prompt, SymmetricMatrix* random, uint64_t detectorMask = kAllDetectors) const;
+   /// Fills the energies of all triples into the prompt or random cube, either cube can be a nullptr.
+   void FillCubes(SymmetricCube* prompt, SymmetricCube* random, uint64_t detectorMask = kAllDetectors) const;
+   /// Fills the time difference of all pairs within reach of either window (including those between the windows), the sign is given by the order of
+   /// detector type and index (so the spectrum is independent of which hit came first).
+   void FillTimeDifference(TH1* hist, uint64_t detectorMask = kAllDetectors) const;
+
+private:
+   bool Classify(double difference, EWindow& window) const
+   {
+      if(difference <= fPrompt) {
+         window = EWindow::kPrompt;
+         return true;
+      }
+      if(difference >= fRandomLow && difference <= fRandomHigh) {
+         window = EWindow::kRandom;
+         return true;
+      }
+      return false;
+   }
+   bool InMask(size_t hit, uint64_t mask) const { return mask == kAllDetectors || (fDetector[hit] < 64 && ((mask >> fDetector[hit]) & 1U) != 0); }
+
+   std::vector<uint8_t>  fDetector;
+   std::vector<uint16_t> fIndex;
+   std::vector<double>   fEnergy;
+   std::vector<double>   fTime;
+   bool                  fSorted{true};
+
+   // buffers for sorting (kept to avoid allocations)
+   std::vector<uint32_t> fOrder;
+   std::vector<uint8_t>  fDetectorBuffer;
+   std::vector<uint16_t> fIndexBuffer;
+   std::vector<double>   fEnergyBuffer;
+   std::vector<double>   fTimeBuffer;
+
+   double fPrompt{0.};
+   double fRandomLow{0.};
+   double fRandomHigh{0.};
+   double fReach{0.};
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef COLUMNHELPER_H
+#define COLUMNHELPER_H
+
+#include <tuple>
+#include <type_traits>
+#include <string>
+#include <vector>
+
+#include "ROOT/RVec.hxx"
+#include "ROOT/RDataFrame.hxx"
+
+#include "BasicHelper.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Declarative column binding for helpers. Each column is described by a tag
+/// type with the branch name and the type the branch is stored as:
+/// \code
+/// HIGS_COLUMN(CrossAmplitude, "clover_cross.amplitude", double);
+/// \endcode
+/// declares a column CrossAmplitude that is read as ROOT::RVec<double>, and
+/// \code
+/// HIGS_SCALAR_COLUMN(Entry, "rdfentry_", ULong64_t);
+/// \endcode
+/// declares a column that is a single value per entry. The
+/// list of tags given to ColumnHelper generates the template arguments and
+/// column names of the call to Book, so they can't get out of order, and the
+/// columns are handed to the helper as one ColumnView. As long as the type
+/// in the descriptor matches the type on disk, RDataFrame hands out views of
+/// its own buffers (no copies and no conversions), if it doesn't match
+/// RDataFrame throws an exception when booking the helper.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+// NOLINTBEGIN(cppcoreguidelines-macro-usage)
+#define HIGS_COLUMN(tag, branch, storedType)                     \
+   struct tag {                                                  \
+      using type = ROOT::RVec<storedType>;                       \
+      static constexpr const char* Name() { return branch; }     \
+   }
+#define HIGS_SCALAR_COLUMN(tag, branch, storedType)              \
+   struct tag {                                                  \
+      using type = storedType;                                   \
+      static constexpr const char* Name() { return branch; }     \
+   }
+// NOLINTEND(cppcoreguidelines-macro-usage)
+
+namespace ColumnDetail {
+/// index of the tag T in the list of tags
+template <typename T, typename... Tags>
+struct IndexOf;
+template <typename T, typename... Tags>
+struct IndexOf<T, T, Tags...> : std::integral_constant<size_t, 0> {};
+template <typename T, typename U, typename... Tags>
+struct IndexOf<T, U, Tags...> : std::integral_constant<size_t, 1 + IndexOf<T, Tags...>::value> {};
+}   // namespace ColumnDetail
+
+/// Typed view of all columns of one event, the columns are accessed by their tag, e.g. event.Get<CrossAmplitude>().
+template <typename... Columns>
+class ColumnView {
+public:
+   explicit ColumnView(typename Columns::type&... columns)
+      : fColumns(&columns...)
+   {
+   }
+
+   template <typename Column>
+   const typename Column::type& Get() const
+   {
+      return *std::get<ColumnDetail::IndexOf<Column, Columns...>::value>(fColumns);
+   }
+
+   static std::vector<std::string> Names() { return {Columns::Name()...}; }
+
+private:
+   std::tuple<typename Columns::type*...> fColumns;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \class ColumnHelper
+///
+/// Base class for helpers using a column descriptor. Derived is the helper
+/// itself, which needs to implement
+/// \code
+/// void Process(unsigned int slot, const View& event);
+/// \endcode
+/// instead of Exec and Book.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Derived, typename... Columns>
+class ColumnHelper : public BasicHelper, public ROOT::Detail::RDF::RActionImpl<Derived> {
+public:
+   using View = ColumnView<Columns...>;
+
+   explicit ColumnHelper(TList* input)
+      : BasicHelper(input)
+   {
+   }
+
+   ROOT::RDF::RResultPtr<std::map<std::string, TList>> Book(ROOT::RDataFrame* d) override
+   {
+      return d->Book<typename Columns::type...>(std::move(static_cast<Derived&>(*this)), View::Names());
+   }
+
+   /// Called by RDataFrame for every event, hands the columns to the helper as one view.
+   void Exec(unsigned int slot, typename Columns::type&... columns)
+   {
+      static_cast<Derived*>(this)->Process(slot, View(columns...));
+   }
+};
+
+#endif
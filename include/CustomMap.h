@@ -1,31 +1,106 @@
 #ifndef TGRSIMAP_H
 #define TGRSIMAP_H
 
-#include <map>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <sstream>
-#include <initializer_list>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
 
 /** \addtogroup Sorting
  *  * @{
  *  */
 
+template <typename key_type>
+class CustomMapException;
+
+////////////////////////////////////////////////////////////
+///
+/// Key with a precomputed hash, for string keys that are
+/// known at compile time:
+/// \code
+/// static constexpr CustomMapKey kCrossE("crossE");
+/// fH1[slot].at(kCrossE)->Fill(energy);
+/// \endcode
+/// String literals passed to at() directly are hashed via
+/// the same constexpr function, which the compiler can
+/// evaluate at compile time as well.
+///
+////////////////////////////////////////////////////////////
+
+class CustomMapKey {
+public:
+   /// 64 bit FNV-1a hash
+   static constexpr uint64_t Hash(std::string_view key)
+   {
+      uint64_t hash = 14695981039346656037ULL;
+      for(char c : key) {
+         hash ^= static_cast<uint64_t>(static_cast<unsigned char>(c));
+         hash *= 1099511628211ULL;
+      }
+      return hash;
+   }
+
+   constexpr CustomMapKey(std::string_view key)   // NOLINT(google-explicit-constructor)
+      : fKey(key), fHash(Hash(key))
+   {
+   }
+   template <size_t N>
+   constexpr CustomMapKey(const char (&key)[N])   // NOLINT(google-explicit-constructor, cppcoreguidelines-avoid-c-arrays)
+      : fKey(key, N - 1), fHash(Hash(fKey))
+   {
+   }
+
+   constexpr std::string_view Key() const { return fKey; }
+   constexpr uint64_t         HashValue() const { return fHash; }
+
+private:
+   std::string_view fKey;
+   uint64_t         fHash;
+};
+
 ////////////////////////////////////////////////////////////
 ///
 /// This class re-implements std::map with more explicit
 /// exceptions replacing out-of-range exceptions.
 ///
+/// The entries are stored in a flat vector (in the order
+/// they were inserted) with an open-addressing hash index,
+/// so a lookup is a hash and (usually) a single comparison
+/// instead of walking a tree of nodes. For string keys the
+/// lookup also works with std::string_view, const char*, or
+/// a CustomMapKey without creating a std::string.
+///
+/// Unlike std::map (which this class used to be based on):
+///  - iterating goes through the entries in the order they were
+///    inserted, not sorted by key, so e.g. the objects of a
+///    helper are written to the output in the order they were
+///    created in CreateHistograms, and
+///  - as with std::vector, inserting new keys can invalidate
+///    references to the values and all iterators, so helpers
+///    must not keep a reference or pointer to a value (e.g.
+///    &fH1[slot]["name"]) while adding keys, only the values
+///    themselves (the histogram pointers) stay valid.
+///
 ////////////////////////////////////////////////////////////
 
-template <typename key_type>
-class CustomMapException;
-
-template <typename key_type, typename mapped_type, typename key_compare = std::less<key_type>,
-          typename allocator_type = std::allocator<std::pair<const key_type, mapped_type>>>
+template <typename key_type, typename mapped_type>
 class CustomMap {
+   static constexpr bool kStringKey = std::is_same<key_type, std::string>::value;
+
 public:
+   using value_type     = std::pair<key_type, mapped_type>;
+   using iterator       = typename std::vector<value_type>::iterator;
+   using const_iterator = typename std::vector<value_type>::const_iterator;
+   using size_type      = size_t;
+
    CustomMap()                                = default;
    CustomMap(const CustomMap&)                = default;
    CustomMap(CustomMap&&) noexcept            = default;
@@ -35,76 +110,204 @@ public:
 
    void Print()
    {
-      for(auto iter : fMap) {
+      for(auto& iter : fEntries) {
          std::cout << iter.first << " - " << iter.second << std::endl;
       }
    }
 
-   mapped_type& at(const key_type& key)
+   template <typename K>
+   mapped_type& at(const K& key)
    {
-      try {
-         return fMap.at(key);
-      } catch(std::exception& e) {
-         throw CustomMapException<key_type>(key, fMap);
+      auto index = Find(key);
+      if(index == kNotFound) {
+         throw CustomMapException<key_type>(ToKey(key), *this);
       }
+      return fEntries[index].second;
    }
-   const mapped_type& at(const key_type& key) const
+   template <typename K>
+   const mapped_type& at(const K& key) const
    {
-      try {
-         return fMap.at(key);
-      } catch(std::exception& e) {
-         throw CustomMapException<key_type>(key, fMap);
+      auto index = Find(key);
+      if(index == kNotFound) {
+         throw CustomMapException<key_type>(ToKey(key), *this);
       }
+      return fEntries[index].second;
    }
 
-   mapped_type&       operator[](const key_type& key) { return fMap[key]; }
-   const mapped_type& operator[](const key_type& key) const { return fMap[key]; }
+   template <typename K>
+   mapped_type& operator[](const K& key)
+   {
+      auto hash  = HashOf(key);
+      auto index = Find(key, hash);
+      if(index == kNotFound) {
+         index = Insert(ToKey(key), mapped_type(), hash);
+      }
+      return fEntries[index].second;
+   }
+   template <typename K>
+   const mapped_type& operator[](const K& key) const { return at(key); }
 
-   using map_t = std::map<key_type, mapped_type, key_compare, allocator_type>;
-   typename map_t::iterator       begin() { return fMap.begin(); }
-   typename map_t::const_iterator begin() const { return fMap.begin(); }
-   typename map_t::iterator       end() { return fMap.end(); }
-   typename map_t::const_iterator end() const { return fMap.end(); }
+   iterator       begin() { return fEntries.begin(); }
+   const_iterator begin() const { return fEntries.begin(); }
+   iterator       end() { return fEntries.end(); }
+   const_iterator end() const { return fEntries.end(); }
 
    // capacity functions of std::map
-   bool   empty() const noexcept { return fMap.empty(); }
-   size_t size() const noexcept { return fMap.size(); }
-   size_t max_size() const noexcept { return fMap.max_size(); }
+   bool   empty() const noexcept { return fEntries.empty(); }
+   size_t size() const noexcept { return fEntries.size(); }
+   size_t max_size() const noexcept { return fEntries.max_size(); }
+   void   reserve(size_t size)
+   {
+      fEntries.reserve(size);
+      fHashes.reserve(size);
+      if(2 * size > fIndex.size()) { Rehash(2 * size); }
+   }
    // modifier functions of std::map
-   void clear() noexcept { fMap.clear(); }
-   // insert
-   // insert_or_assign
-   // emplace
+   void clear() noexcept
+   {
+      fEntries.clear();
+      fHashes.clear();
+      fIndex.clear();
+   }
    template <class... Args>
-   std::pair<typename map_t::iterator, bool> emplace(Args&&... args)
+   std::pair<iterator, bool> emplace(Args&&... args)
    {
-      return fMap.emplace(args...);
+      value_type entry(std::forward<Args>(args)...);
+      auto       hash  = HashOf(entry.first);
+      auto       index = Find(entry.first, hash);
+      if(index != kNotFound) {
+         return {fEntries.begin() + static_cast<std::ptrdiff_t>(index), false};
+      }
+      index = Insert(std::move(entry.first), std::move(entry.second), hash);
+      return {fEntries.begin() + static_cast<std::ptrdiff_t>(index), true};
+   }
+   iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+   iterator erase(const_iterator first, const_iterator last)
+   {
+      // erasing is rare, so we simply rebuild the index
+      auto offset = std::distance(fEntries.cbegin(), first);
+      fHashes.erase(fHashes.begin() + offset, fHashes.begin() + std::distance(fEntries.cbegin(), last));
+      auto result = fEntries.erase(first, last);
+      Rehash(fIndex.size());
+      return result;
+   }
+   void swap(CustomMap& other) noexcept
+   {
+      fEntries.swap(other.fEntries);
+      fHashes.swap(other.fHashes);
+      fIndex.swap(other.fIndex);
    }
-   // emplace_hint
-   // try_emplace
-   void erase(typename map_t::iterator pos) { fMap.erase(pos); }
-   void erase(typename map_t::iterator first, typename map_t::iterator last) { fMap.erase(first, last); }
-   void swap(map_t& other) { fMap.swap(other); }
    // lookup functions of std::map
-   typename map_t::size_type      count(const key_type* key) const { return fMap.count(key); }
-   typename map_t::iterator       find(const key_type& key) { return fMap.find(key); }
-   typename map_t::const_iterator find(const key_type& key) const { return fMap.find(key); }
-   // equal_range
-   // lower_bound
-   // upper_bound
+   template <typename K>
+   size_type count(const K& key) const { return Find(key) == kNotFound ? 0 : 1; }
+   template <typename K>
+   iterator find(const K& key)
+   {
+      auto index = Find(key);
+      return index == kNotFound ? fEntries.end() : fEntries.begin() + static_cast<std::ptrdiff_t>(index);
+   }
+   template <typename K>
+   const_iterator find(const K& key) const
+   {
+      auto index = Find(key);
+      return index == kNotFound ? fEntries.end() : fEntries.begin() + static_cast<std::ptrdiff_t>(index);
+   }
 
 private:
-   std::map<key_type, mapped_type, key_compare, allocator_type> fMap;
+   static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+   static uint64_t HashOf(const CustomMapKey& key) { return key.HashValue(); }
+   template <typename K>
+   static uint64_t HashOf(const K& key)
+   {
+      if constexpr(kStringKey) {
+         return CustomMapKey::Hash(std::string_view(key));
+      } else {
+         return std::hash<key_type>()(key);
+      }
+   }
+
+   template <typename K>
+   static bool Equal(const key_type& lhs, const K& rhs)
+   {
+      if constexpr(std::is_same<K, CustomMapKey>::value) {
+         return std::string_view(lhs) == rhs.Key();
+      } else if constexpr(kStringKey) {
+         return std::string_view(lhs) == std::string_view(rhs);
+      } else {
+         return lhs == rhs;
+      }
+   }
+
+   template <typename K>
+   static key_type ToKey(const K& key)
+   {
+      if constexpr(std::is_same<K, CustomMapKey>::value) {
+         return key_type(key.Key());
+      } else {
+         return key_type(key);
+      }
+   }
+
+   template <typename K>
+   size_t Find(const K& key) const { return Find(key, HashOf(key)); }
+   template <typename K>
+   size_t Find(const K& key, uint64_t hash) const
+   {
+      if(fIndex.empty()) { return kNotFound; }
+      size_t mask = fIndex.size() - 1;
+      for(size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+         auto slot = fIndex[pos];
+         if(slot == 0) { return kNotFound; }
+         if(fHashes[slot - 1] == hash && Equal(fEntries[slot - 1].first, key)) { return slot - 1; }
+      }
+   }
+
+   size_t Insert(key_type&& key, mapped_type&& value, uint64_t hash)
+   {
+      // keep the load factor of the index at or below 1/2, so probe sequences stay short
+      if(2 * (fEntries.size() + 1) > fIndex.size()) {
+         Rehash(std::max<size_t>(16, 2 * fIndex.size()));
+      }
+      fEntries.emplace_back(std::move(key), std::move(value));
+      fHashes.push_back(hash);
+      Place(fEntries.size() - 1);
+      return fEntries.size() - 1;
+   }
+
+   void Place(size_t entry)
+   {
+      size_t mask = fIndex.size() - 1;
+      size_t pos  = fHashes[entry] & mask;
+      while(fIndex[pos] != 0) { pos = (pos + 1) & mask; }
+      fIndex[pos] = static_cast<uint32_t>(entry + 1);
+   }
+
+   void Rehash(size_t size)
+   {
+      // the size of the index is always a power of 2
+      size_t newSize = 16;
+      while(newSize < size) { newSize *= 2; }
+      fIndex.assign(newSize, 0);
+      for(size_t entry = 0; entry < fEntries.size(); ++entry) {
+         Place(entry);
+      }
+   }
+
+   std::vector<value_type> fEntries;   ///< all keys and values in the order they were inserted
+   std::vector<uint64_t>   fHashes;    ///< hash of each key (same order as the entries)
+   std::vector<uint32_t>   fIndex;     ///< open-addressing index, 0 = empty, otherwise the position of the entry + 1
 };
 
 template <typename key_type>
 class CustomMapException : public std::exception {
 public:
-   template <typename mapped_type, typename key_compare, typename allocator_type>
-   CustomMapException(const key_type key, const std::map<key_type, mapped_type, key_compare, allocator_type>& map)
+   /// Works for any map that iterates over pairs of keys and values (std::map or CustomMap).
+   template <typename map_type>
+   CustomMapException(const key_type key, const map_type& map)
       : std::exception(), fKey(key)
    {
-      for(auto iter : map) {
+      for(const auto& iter : map) {
          fKeys.push_back(iter.first);
       }
    }
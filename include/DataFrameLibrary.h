@@ -9,6 +9,9 @@
 #include "Singleton.h"
 #include "BasicHelper.h"
 
+/// This checks if the path exist, and if it is a file and not a directory!
+bool FileExists(const char* filename);
+
 class DataFrameLibrary : public Singleton<DataFrameLibrary> {
 public:
    friend class Singleton<DataFrameLibrary>;
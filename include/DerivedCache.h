@@ -0,0 +1,64 @@
+#ifndef DERIVEDCACHE_H
+#define DERIVEDCACHE_H
+
+#include <string>
+
+#include "Rtypes.h"
+
+#include "Calibration.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class DerivedCache
+///
+/// Cache of derived columns that every helper would otherwise
+/// compute from the raw columns again: the calibrated energies
+/// and times of the cross, back, and misc detectors, and the
+/// addback of the cross crystals. The columns of each input file
+/// are written once to a friend tree (higs_derived) in a file in
+/// the cache directory, keyed by the input file and a hash of the
+/// calibration, so any later run on the same file with the same
+/// calibration reuses them.
+///
+/// The columns are vectors with one entry per channel (NaN where
+/// the amplitude is NaN), except for the addback columns, which
+/// have one entry per addback hit:
+/// - clover_cross_energy, clover_cross_time (ids 0-15)
+/// - clover_back_energy, clover_back_time (ids 16-31)
+/// - misc_energy, misc_time (ids 32-47)
+/// - clover_cross_addback_energy, clover_cross_addback_time,
+///   clover_cross_addback_clover (4 crystals per clover in a
+///   square, neighbours only, 50 ns time gate)
+///
+/// Since the calibration dithers the channels, the dithering is
+/// done once when the cache is written and is the same for all
+/// runs that use the cache. The random numbers for it are seeded
+/// with the hash of the input file and calibration, so any run
+/// writing the cache writes the same values.
+///
+/////////////////////////////////////////////////////////////////
+
+class DerivedCache {
+public:
+   static constexpr const char* kTreeName = "higs_derived";
+
+   DerivedCache(std::string directory, const Calibration* calibration, std::string treeName);
+
+   /// Returns the cache file for the first entries of the input file, writing it first if it doesn't exist yet or has
+   /// a different number of entries (e.g. because the file grew).
+   std::string Ensure(const std::string& file, Long64_t entries) const;
+
+private:
+   /// Hash of the canonical path of the input file and the calibration.
+   ULong64_t Hash(const std::string& file) const;
+   /// Name of the cache file for the input file (input file name plus the hash).
+   std::string FileName(const std::string& file) const;
+   /// Writes the derived columns of the first entries of the input file to the cache file.
+   void Write(const std::string& file, const std::string& cacheFile, Long64_t entries) const;
+
+   std::string        fDirectory;
+   const Calibration* fCalibration{nullptr};
+   std::string        fTreeName;   ///< name of the tree in the input files
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <csignal>
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class FileWatcher
+///
+/// A simple class that watches one or more directories for new
+/// files (using inotify on linux) whose names end in a given
+/// suffix. Only files that have been closed after writing or
+/// that have been moved into the directory are reported, so a
+/// file that is still being written by the converter is not
+/// picked up too early.
+/// On systems without inotify the directories are polled
+/// instead, comparing the directory content to the one seen
+/// before.
+///
+/////////////////////////////////////////////////////////////////
+
+class FileWatcher {
+public:
+   FileWatcher(const std::vector<std::string>& directories, std::string suffix);
+   ~FileWatcher();
+
+   FileWatcher(const FileWatcher&)            = delete;
+   FileWatcher(FileWatcher&&)                 = delete;
+   FileWatcher& operator=(const FileWatcher&) = delete;
+   FileWatcher& operator=(FileWatcher&&)      = delete;
+
+   /// Waits at most timeout milliseconds for new files and returns their full paths (can be empty).
+   std::vector<std::string> Wait(int timeout);
+
+   /// Signals Wait to return as soon as possible (safe to call from a signal handler).
+   static void Stop() { fStop = 1; }
+   static bool Stopped() { return fStop != 0; }
+
+private:
+   std::vector<std::string> Poll();
+   bool                     Matches(const std::string& name) const;
+
+   std::string                fSuffix;
+   int                        fDescriptor{-1};   ///< inotify file descriptor
+   std::map<int, std::string> fWatches;          ///< map of watch descriptors to directories
+   std::vector<std::string>   fDirectories;      ///< directories watched
+   std::vector<std::string>   fKnownFiles;       ///< files already seen (only used when polling)
+
+   static volatile sig_atomic_t fStop;
+};
+
+#endif
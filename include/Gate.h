@@ -0,0 +1,76 @@
+#ifndef GATE_H
+#define GATE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "ROOT/RVec.hxx"
+#include "TCutG.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class Gate
+///
+/// Fast version of a TCutG for use in the event loop. When the
+/// gate is created, the bounding box of the polygon is divided
+/// into a grid of cells, and each cell is marked as either
+/// completely inside, completely outside, or on the boundary of
+/// the polygon. Testing a point is then a lookup of its cell,
+/// only points in boundary cells need the exact point-in-polygon
+/// test over all vertices.
+///
+/// BasicHelper creates one gate for each cut in fCuts at the
+/// end of Setup (in fGates, using the same key), the gates are
+/// read-only so they can be used by all slots.
+///
+/////////////////////////////////////////////////////////////////
+
+class Gate {
+public:
+   /// Creates the gate from the polygon of the cut, using a grid of cells x cells.
+   explicit Gate(const TCutG* cut, int cells = 128);
+
+   bool IsInside(double x, double y) const
+   {
+      if(!(x >= fMinX && x <= fMaxX && y >= fMinY && y <= fMaxY)) { return false; }   // also false for NaN
+      auto column = static_cast<int>((x - fMinX) * fScaleX);
+      auto row    = static_cast<int>((y - fMinY) * fScaleY);
+      if(column >= fCells) { column = fCells - 1; }
+      if(row >= fCells) { row = fCells - 1; }
+      auto cell = fGrid[static_cast<size_t>(row) * fCells + column];
+      if(cell != kBoundary) { return cell == kInside; }
+      return IsInsidePolygon(x, y);
+   }
+
+   /// Tests all points (x[i], y[i]) and sets result[i] to 1 if the point is inside, 0 otherwise.
+   void IsInside(const ROOT::RVecD& x, const ROOT::RVecD& y, ROOT::RVec<char>& result) const;
+   /// Returns the number of points (x[i], y[i]) inside the gate.
+   size_t Count(const ROOT::RVecD& x, const ROOT::RVecD& y) const;
+
+   const std::string& Name() const { return fName; }
+   /// Fraction of cells that need the exact test (for checking whether the grid is fine enough).
+   double BoundaryFraction() const;
+
+private:
+   enum ECell : uint8_t { kOutside,
+                          kInside,
+                          kBoundary };
+
+   /// Exact test (crossing number) over all edges of the polygon.
+   bool IsInsidePolygon(double x, double y) const;
+
+   std::string          fName;
+   std::vector<double>  fX;
+   std::vector<double>  fY;
+   std::vector<uint8_t> fGrid;
+   int                  fCells{0};
+   double               fMinX{0.};
+   double               fMaxX{0.};
+   double               fMinY{0.};
+   double               fMaxY{0.};
+   double               fScaleX{0.};
+   double               fScaleY{0.};
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef HISTOGRAMDEFINITIONS_H
+#define HISTOGRAMDEFINITIONS_H
+
+#include <string>
+#include <vector>
+
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+
+#include "CustomMap.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class HistogramDefinitions
+///
+/// Histograms declared in a text file (--histograms), which are
+/// created for each slot after the histograms of CreateHistograms,
+/// so binning can be changed and spectra added without
+/// recompiling the helper. Each line declares one histogram:
+/// \code
+/// # type key bins low high [bins low high [bins low high]] [title]
+/// TH1F crossE         8000 0 4000 Cross energy;energy [keV];counts/0.5 keV
+/// TH2F timing/crossT  1000 -2000 2000 15 0.5 15.5 Cross ID vs time;time [ns];Cross ID
+/// \endcode
+/// The type is TH1F, TH1D, TH1I, TH2F, ..., TH3I, and the number of
+/// axes follows from it. The key is the key in fH1, fH2, or fH3 and
+/// the path of the histogram in the output file (like for histograms
+/// created in code), the rest of the line is the title (the name of
+/// the histogram if it's empty). Lines starting with # are comments.
+/// A histogram with the same key as one created by CreateHistograms
+/// replaces it, keeping its position in the map (and its handle).
+///
+/////////////////////////////////////////////////////////////////
+
+class HistogramDefinitions {
+public:
+   /// Reads all definitions from the file, throws if the file can't be read or a line can't be parsed.
+   explicit HistogramDefinitions(const std::string& fileName);
+
+   size_t Size() const { return fDefinitions.size(); }
+
+   /// Creates all histograms in the maps of one slot.
+   void Create(CustomMap<std::string, TH1*>& h1, CustomMap<std::string, TH2*>& h2, CustomMap<std::string, TH3*>& h3) const;
+
+private:
+   struct Axis {
+      int    fBins{0};
+      double fLow{0.};
+      double fHigh{0.};
+   };
+   struct Definition {
+      std::string       fType;
+      std::string       fKey;
+      std::string       fName;
+      std::string       fTitle;
+      std::vector<Axis> fAxes;
+   };
+
+   static TH1* Create(const Definition& definition);
+
+   std::string             fFileName;
+   std::vector<Definition> fDefinitions;
+};
+
+#endif
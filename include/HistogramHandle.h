@@ -0,0 +1,46 @@
+#ifndef HISTOGRAMHANDLE_H
+#define HISTOGRAMHANDLE_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \class HistogramHandle
+///
+/// Pre-resolved reference to a histogram of a helper, so filling it in Exec
+/// doesn't need to look up its key. The handle is the position of the
+/// histogram in the map of each slot, which is the same for all slots as
+/// long as CreateHistograms creates the histograms in the same order for
+/// every slot (lazy slots are cloned from the prototype in order anyway).
+/// The key is kept so that builds without NDEBUG can check that the
+/// histogram at this position is still the one the handle was created for.
+/// \code
+/// // in the constructor, after Setup
+/// fCrossE = H1Handle("crossE");
+/// // in Exec/Process
+/// H1(slot, fCrossE)->Fill(energy);
+/// \endcode
+///
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+class HistogramHandle {
+public:
+   HistogramHandle() = default;
+   HistogramHandle(size_t index, std::string key)
+      : fIndex(index), fKey(std::move(key))
+   {
+   }
+
+   size_t             Index() const { return fIndex; }
+   const std::string& Key() const { return fKey; }
+   bool               Valid() const { return fIndex != static_cast<size_t>(-1); }
+
+private:
+   size_t      fIndex{static_cast<size_t>(-1)};   ///< position of the histogram in the map of each slot
+   std::string fKey;                              ///< key of the histogram, only used to check the position
+};
+
+#endif
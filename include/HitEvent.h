@@ -0,0 +1,106 @@
+#ifndef HITEVENT_H
+#define HITEVENT_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <array>
+#include <string>
+
+#include "ROOT/RVec.hxx"
+
+#include "Calibration.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class HitEvent
+///
+/// All valid hits (i.e. channels whose value isn't NaN) of the
+/// current event of one data processing slot, with calibrated
+/// energy, time, detector type, and global detector id, stored
+/// as structure of arrays. The hits are added one detector type
+/// at a time, so the hits of each type are contiguous.
+///
+/// Each slot has one HitEvent per calibration and detector
+/// layout (a name for the detectors the helper adds and their
+/// first ids), shared by all helpers using the same ones. It is
+/// built once per event (the first helper that calls Begin with
+/// a new entry number builds it, all others just use it), and
+/// the buffers are kept between events, so there are no
+/// allocations once they have grown to the largest event.
+///
+/// \code
+/// auto& hits = HitEvent::ForSlot(slot, fCalibration, "cross+back");
+/// if(hits.Begin(entry)) {
+///    hits.Add(0, 0, crossAmplitude, crossChannelTime, fCalibration);
+///    hits.Add(1, 16, backAmplitude, backChannelTime, fCalibration);
+/// }
+/// for(size_t hit = 0; hit < hits.Size(); ++hit) { ... }
+/// \endcode
+///
+/////////////////////////////////////////////////////////////////
+
+class HitEvent {
+public:
+   static constexpr size_t kMaxTypes = 16;
+
+   /// Creates the hit events for all slots (called by BasicHelper::Setup before the event loop starts).
+   static void Slots(unsigned int nSlots);
+   /// Forgets the events built so far in all slots (called by BasicHelper::Initialize before each event loop, as the
+   /// entry numbers start at 0 again in every event loop, e.g. each pass in follow mode).
+   static void NewLoop();
+   /// Returns the hit event of this slot built with this calibration and detector layout (created the first time
+   /// it's used). Helpers that add different detectors (or the same detectors with different ids) need different
+   /// layouts, otherwise they get the hits of whichever helper built the event first.
+   static HitEvent& ForSlot(unsigned int slot, const Calibration* calibration, const std::string& layout);
+
+   HitEvent(const Calibration* calibration, std::string layout);
+
+   /// Starts a new event, returns false if the event with this entry number has already been built.
+   bool Begin(uint64_t entry)
+   {
+      if(fBuilt && entry == fEntry) { return false; }
+      fEntry = entry;
+      fBuilt = true;
+      fEnergy.clear();
+      fTime.clear();
+      fId.clear();
+      fType.clear();
+      fTypeBegin.fill(0);
+      fTypeEnd.fill(0);
+      return true;
+   }
+
+   /// Adds all valid channels of one detector type, the global id and calibration id of channel i is firstId + i.
+   /// Without calibration (nullptr) the values are used as they are.
+   void Add(uint8_t type, uint16_t firstId, const ROOT::RVecD& value, const ROOT::RVecD& time, const Calibration* calibration);
+
+   size_t   Size() const { return fEnergy.size(); }
+   double   Energy(size_t hit) const { return fEnergy[hit]; }
+   double   Time(size_t hit) const { return fTime[hit]; }
+   uint16_t Id(size_t hit) const { return fId[hit]; }
+   uint8_t  Type(size_t hit) const { return fType[hit]; }
+   /// Range [first, second) of the hits of this detector type.
+   std::pair<size_t, size_t> Range(uint8_t type) const { return {fTypeBegin[type], fTypeEnd[type]}; }
+
+   const std::vector<double>&   Energies() const { return fEnergy; }
+   const std::vector<double>&   Times() const { return fTime; }
+   const std::vector<uint16_t>& Ids() const { return fId; }
+
+private:
+   static std::vector<std::vector<std::unique_ptr<HitEvent>>>& Events();
+
+   const Calibration*            fCalibration;   ///< calibration this event is built with (only used as key)
+   std::string                   fLayout;        ///< detector layout this event is built with
+   uint64_t                      fEntry{0};
+   bool                          fBuilt{false};
+   std::vector<double>           fEnergy;
+   std::vector<double>           fTime;
+   std::vector<uint16_t>         fId;
+   std::vector<uint8_t>          fType;
+   std::array<size_t, kMaxTypes> fTypeBegin{};
+   std::array<size_t, kMaxTypes> fTypeEnd{};
+};
+
+#endif
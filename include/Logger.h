@@ -0,0 +1,164 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <iostream>
+#include <cstdint>
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class Logger
+///
+/// Asynchronous logging for code that runs inside the event
+/// loop. Each data processing slot gets its own single-producer
+/// single-consumer ring buffer, so a slot writing a message never
+/// waits for a lock or for the disk. A background thread drains
+/// the buffers into the log file that stdout is redirected to.
+///
+/// Messages are rate-limited per call site and slot: only the
+/// first few messages of each call site are logged, all others
+/// are just counted, and a summary of each call site is written
+/// when the logger is closed. Identical messages (of any slot)
+/// are only written once per window (one second by default), the
+/// number of repeats is written once the window is over.
+///
+/// Messages are logged via the macro
+/// \code
+/// HIGS_LOG(slot, "Failed to fill channel " << i << ": " << e.what());
+/// \endcode
+/// which only builds the message if it isn't suppressed.
+/// If the logger isn't open (i.e. outside of the event loop)
+/// messages are written to std::cout directly (still
+/// rate-limited).
+///
+/////////////////////////////////////////////////////////////////
+
+class Logger {
+public:
+   static Logger& Get();
+
+   Logger(const Logger&)            = delete;
+   Logger(Logger&&)                 = delete;
+   Logger& operator=(const Logger&) = delete;
+   Logger& operator=(Logger&&)      = delete;
+   ~Logger() { Close(); }
+
+   /// Opens the log file (appending to it) and starts the background thread, nothing happens if the file is a nullptr.
+   void Open(const char* fileName, unsigned int nSlots);
+   /// Stops the background thread, writes all remaining messages and the summary of all call sites, and closes the file.
+   void Close();
+
+   bool IsOpen() const { return fFileDescriptor >= 0; }
+
+   /// Sets how many messages of each call site are logged per slot before they are suppressed.
+   void Limit(uint64_t limit) { fLimit = limit; }
+   /// Sets the time (in seconds) within which identical messages are only written once.
+   void Window(double seconds) { fWindow = std::chrono::duration<double>(seconds); }
+   /// Sets the number of messages each slot can buffer (only used when the logger is opened), messages that don't fit are dropped.
+   void Capacity(size_t capacity) { fCapacity = capacity; }
+
+   /// Returns the id of this call site, called once per call site.
+   size_t RegisterSite(const char* file, int line);
+
+   /// Logs the message created by the function if this call site of this slot hasn't reached the limit yet.
+   template <typename Message>
+   void Log(unsigned int slot, size_t site, Message&& message)
+   {
+      if(IsOpen() && slot < fSlots.size()) {
+         auto& data = *fSlots[slot];
+         if(data.Count(site) > fLimit) { return; }
+         data.Push(message());
+         return;
+      }
+      // the logger isn't open, so we write to std::cout directly
+      std::lock_guard<std::mutex> lock(fMutex);
+      if(fUnbuffered.Count(site) > fLimit) { return; }
+      std::cout << slot << ": " << message() << std::endl;
+   }
+
+private:
+   Logger() = default;
+
+   /// Ring buffer and counters of one slot. Only the slot itself pushes and counts, only the background thread pops.
+   class SlotData {
+   public:
+      explicit SlotData(size_t capacity = 0) : fBuffer(capacity) {}
+
+      uint64_t Count(size_t site)
+      {
+         if(site >= fCounts.size()) { fCounts.resize(site + 1, 0); }
+         return ++fCounts[site];
+      }
+      void Push(std::string&& message)
+      {
+         auto head = fHead.load(std::memory_order_relaxed);
+         if(head - fTail.load(std::memory_order_acquire) >= fBuffer.size()) {
+            ++fDropped;   // buffer is full, we rather drop the message than wait
+            return;
+         }
+         fBuffer[head % fBuffer.size()] = std::move(message);
+         fHead.store(head + 1, std::memory_order_release);
+      }
+      bool Pop(std::string& message)
+      {
+         auto tail = fTail.load(std::memory_order_relaxed);
+         if(tail == fHead.load(std::memory_order_acquire)) { return false; }
+         message = std::move(fBuffer[tail % fBuffer.size()]);
+         fTail.store(tail + 1, std::memory_order_release);
+         return true;
+      }
+
+      std::vector<uint64_t> fCounts;       ///< number of messages per call site
+      uint64_t              fDropped{0};   ///< number of messages dropped because the buffer was full
+
+   private:
+      std::vector<std::string> fBuffer;
+      std::atomic<size_t>      fHead{0};
+      std::atomic<size_t>      fTail{0};
+   };
+
+   /// When a message was first written in the current window, and how often it was repeated since.
+   struct Repeats {
+      std::chrono::steady_clock::time_point fFirst;
+      uint64_t                              fCount{0};
+   };
+
+   void Drain();
+   /// Writes the number of repeats of all messages whose window is over (or of all messages) and forgets them.
+   void EndWindows(std::ostringstream& str, std::chrono::steady_clock::time_point now, bool all);
+   void Write(const std::string& text);
+
+   std::mutex                             fMutex;
+   std::vector<std::string>               fSites;
+   std::vector<std::unique_ptr<SlotData>> fSlots;
+   SlotData                               fUnbuffered;
+   std::thread                            fThread;
+   std::atomic<bool>                      fRunning{false};
+   int                                    fFileDescriptor{-1};
+   uint64_t                               fLimit{10};
+   size_t                                 fCapacity{4096};
+   std::chrono::duration<double>          fWindow{1.};
+   std::map<std::string, Repeats>         fRepeats;   ///< messages written in their current window (only used by the background thread)
+};
+
+// NOLINTBEGIN(cppcoreguidelines-macro-usage)
+#define HIGS_LOG(slot, message)                                                                  \
+   do {                                                                                          \
+      static const size_t higsLogSite = Logger::Get().RegisterSite(__FILE__, __LINE__);         \
+      Logger::Get().Log((slot), higsLogSite, [&]() {                                             \
+         std::ostringstream higsLogStream;                                                      \
+         higsLogStream << message;                                                              \
+         return higsLogStream.str();                                                            \
+      });                                                                                        \
+   } while(false)
+// NOLINTEND(cppcoreguidelines-macro-usage)
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <atomic>
+#include <string>
+
+#include "TFile.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class MappedFile
+///
+/// Read-only TFile for local files that maps the whole file into
+/// memory (--mmap). Files are opened through it by prefixing
+/// their path with mmap://, TFile::Open finds it via a plugin
+/// handler registered by Enable.
+///
+/// All reads within the mapping (baskets read directly as well
+/// as the blocks of the tree cache) are copied from the mapping
+/// instead of issuing a pread for each of them, and the kernel
+/// is told how the file is going to be read (madvise), so it can
+/// read ahead or load the whole file into the page cache. Reads
+/// beyond the mapping (e.g. a file that grew since it was
+/// opened) fall back to TFile.
+///
+/////////////////////////////////////////////////////////////////
+
+class MappedFile : public TFile {
+public:
+   static constexpr const char* kProtocol = "mmap://";
+
+   /// Registers the plugin handler for mmap:// and sets the madvise hint ("sequential" or "willneed") for all files
+   /// mapped from now on. Throws if the hint is unknown.
+   static void Enable(const std::string& advice);
+
+   /// Number of reads and bytes served from mappings by all files so far (these reads need no system call).
+   static Long64_t MappedReads() { return fgMappedReads; }
+   static Long64_t MappedBytes() { return fgMappedBytes; }
+
+   MappedFile() = default;
+   MappedFile(const char* url, Option_t* option = "", const char* title = "", Int_t compress = ROOT::RCompressionSetting::EDefaults::kUseCompiledDefault);
+   MappedFile(const MappedFile&)            = delete;
+   MappedFile(MappedFile&&)                 = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+   MappedFile& operator=(MappedFile&&)      = delete;
+   ~MappedFile() override;
+
+   Bool_t ReadBuffer(char* buf, Int_t len) override;
+   Bool_t ReadBuffer(char* buf, Long64_t pos, Int_t len) override;
+   Bool_t ReadBuffers(char* buf, Long64_t* pos, Int_t* len, Int_t nbuf) override;
+
+private:
+   /// Path of the file without the mmap:// prefix.
+   static std::string LocalPath(const char* url);
+   bool               Covers(Long64_t pos, Int_t len) const { return fMap != nullptr && pos >= 0 && len >= 0 && pos + len <= fSize; }
+   /// Adds reads served from the mapping to the bytes read by this file and to the (atomic) counters of all mappings.
+   void Count(Long64_t reads, Long64_t bytes);
+
+   const char* fMap{nullptr};   //!<! start of the mapping (nullptr if the file couldn't be mapped)
+   Long64_t    fSize{0};        //!<! size of the mapping
+
+   static int                   fgAdvice;        ///< madvise hint for new mappings
+   static std::atomic<Long64_t> fgMappedReads;   ///< reads served from mappings
+   static std::atomic<Long64_t> fgMappedBytes;   ///< bytes served from mappings
+
+   /// \cond CLASSIMP
+   ClassDefOverride(MappedFile, 0)   // NOLINT(readability-else-after-return)
+   /// \endcond
+};
+
+#endif
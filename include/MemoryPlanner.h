@@ -0,0 +1,76 @@
+#ifndef MEMORYPLANNER_H
+#define MEMORYPLANNER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "TList.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class MemoryPlanner
+///
+/// Estimates the memory a run will need before the event loop
+/// starts, and compares it to the memory that is available to
+/// us (MemAvailable from /proc/meminfo, and the limit of our
+/// cgroup if there is one).
+///
+/// The estimate is based on the output list of a helper with a
+/// single slot: the histograms (bin contents and errors), the
+/// basket buffers of the trees, and the streamed size of all
+/// other objects, multiplied by the number of slots. On top of
+/// that comes the peak of Finalize (expanded symmetric matrices
+/// and cubes, and the streaming buffer or tile of the largest
+/// object), and the memory the process already uses. Merged
+/// trees are not included, as their size depends on the data.
+///
+/// Depending on the policy (--memory-policy) a run that doesn't
+/// fit is only reported, refused, or the number of workers is
+/// reduced until it fits.
+///
+/////////////////////////////////////////////////////////////////
+
+class MemoryPlanner {
+public:
+   enum class EPolicy { kReport,
+                        kRefuse,
+                        kCap };
+
+   /// Converts "report", "refuse", or "cap" to the policy, throws for anything else.
+   static EPolicy Policy(const std::string& name);
+
+   /// Memory we can still use in bytes (the smaller of MemAvailable and the remaining cgroup limit).
+   static Long64_t Available();
+   /// Resident memory of this process in bytes.
+   static Long64_t Resident();
+
+   /// Estimates the memory of one slot from the output lists of a helper that was set up with one slot. With a
+   /// prototype (lazy slots) the helper keeps one more set of objects in addition to the slots.
+   void Estimate(const std::map<std::string, TList>& lists, bool prototype = false);
+
+   /// Prints the plan for this number of slots and applies the policy. Returns the number of slots to use, which is only
+   /// ever smaller than slots for the kCap policy. Throws if the policy is kRefuse and the run doesn't fit.
+   int Plan(int slots, EPolicy policy);
+
+   Long64_t PerSlot() const { return fHistograms + fTrees + fOther; }
+   Long64_t MergePeak() const { return fMergePeak; }
+   /// Memory needed on top of what the process already uses for this number of slots.
+   Long64_t Needed(int slots) const { return (slots + (fPrototype ? 1 : 0)) * PerSlot() + fMergePeak; }
+   /// Total memory of the process for this number of slots.
+   Long64_t Total(int slots) const { return fResident + Needed(slots); }
+
+private:
+   static constexpr double kUsable = 0.9;   ///< fraction of the available memory we plan to use
+
+   Long64_t                                      fHistograms{0};      ///< bin contents and errors of all histograms of one slot
+   Long64_t                                      fTrees{0};           ///< basket buffers of all trees of one slot
+   Long64_t                                      fOther{0};           ///< streamed size of all other objects of one slot
+   Long64_t                                      fMergePeak{0};       ///< additional memory needed at the end of Finalize
+   Long64_t                                      fResident{0};        ///< memory used by this process before the slots are created
+   bool                                          fPrototype{false};   ///< whether the helper keeps a prototype slot
+   std::vector<std::pair<std::string, Long64_t>> fObjects;            ///< size of each object of one slot
+};
+
+#endif
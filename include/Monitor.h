@@ -0,0 +1,77 @@
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+#include "TH1.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class Monitor
+///
+/// Writes merged snapshots of the histograms of all slots to a
+/// file while the event loop is running (--monitor <seconds>).
+/// A background thread collects the histograms of all slots in
+/// regular intervals, merges them, and writes them to a
+/// temporary file that is then renamed, so the snapshot file is
+/// always complete and can be opened at any time.
+///
+/// The slots keep filling their histograms while they are read,
+/// no locks are used, so a snapshot can be off by the events
+/// that were filled while it was merged. Reading a histogram
+/// is only safe as long as filling it doesn't reallocate its
+/// arrays, so histograms with a buffer or extendable axes are
+/// left out (see BasicHelper::MonitoredHistograms). Histograms
+/// that are filled with weights need to call Sumw2() when they
+/// are created, otherwise the first weighted fill allocates the
+/// array of the errors while the monitor might read it. The
+/// symmetric matrices and cubes are not part of the snapshots.
+/// A merged histogram is only rebuilt if the total number of
+/// entries of the histogram in all slots changed since the last
+/// snapshot. The rebuild isn't incremental, it resets the merged
+/// histogram and adds all slots again, as the histograms don't
+/// keep track of which bins changed.
+///
+/////////////////////////////////////////////////////////////////
+
+class Monitor {
+public:
+   /// Histograms of all slots that have been created, with the key of the histogram (path/name) as key.
+   using Histograms = std::map<std::string, std::vector<TH1*>>;
+
+   /// Starts the background thread, collect is called from that thread and has to return the histograms of all slots.
+   Monitor(double interval, std::string fileName, std::function<Histograms()> collect);
+   Monitor(const Monitor&)            = delete;
+   Monitor(Monitor&&)                 = delete;
+   Monitor& operator=(const Monitor&) = delete;
+   Monitor& operator=(Monitor&&)      = delete;
+   ~Monitor();
+
+   /// Stops the background thread (any snapshot being written is finished first).
+   void Stop();
+
+private:
+   void Run();
+   void Snapshot();
+
+   double                                      fInterval;   ///< seconds between snapshots
+   std::string                                 fFileName;
+   std::function<Histograms()>                 fCollect;
+   std::map<std::string, std::unique_ptr<TH1>> fMerged;     ///< merged histograms of the last snapshot
+   std::map<std::string, double>               fEntries;    ///< total entries of all slots in the last snapshot
+   size_t                                      fSnapshots{0};
+
+   std::mutex              fMutex;
+   std::condition_variable fCondition;
+   bool                    fStop{false};
+   std::thread             fThread;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef NUMATOPOLOGY_H
+#define NUMATOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class NumaTopology
+///
+/// NUMA nodes of the machine and the cores of each node that
+/// we are allowed to run on, read from /sys/devices/system/node
+/// (nodes without any of our cores, e.g. memory-only nodes, are
+/// ignored).
+///
+/// With --numa each slot is assigned to a node (round-robin) and
+/// to one core of that node, and BasicHelper pins the thread that
+/// runs a task of the slot to that core. The objects of each slot
+/// are created by a thread that runs on the node of the slot, so
+/// their memory is allocated (first-touched) on that node.
+///
+/// The thread that enabled pinning (the main thread) is never
+/// pinned, even if it runs a task, as it also runs Finalize, the
+/// output, and any later pass in follow mode.
+///
+/// On machines with a single node (or if the topology can't be
+/// read) nothing is pinned.
+///
+/////////////////////////////////////////////////////////////////
+
+class NumaTopology {
+public:
+   static NumaTopology& Get();
+
+   NumaTopology(const NumaTopology&)            = delete;
+   NumaTopology(NumaTopology&&)                 = delete;
+   NumaTopology& operator=(const NumaTopology&) = delete;
+   NumaTopology& operator=(NumaTopology&&)      = delete;
+   ~NumaTopology()                              = default;
+
+   size_t                  Nodes() const { return fCpus.size(); }
+   const std::vector<int>& Cpus(size_t node) const { return fCpus[node]; }
+   /// Node the slot is assigned to.
+   size_t Node(unsigned int slot) const { return slot % Nodes(); }
+   /// Core the slot is pinned to.
+   int Cpu(unsigned int slot) const;
+
+   /// Enables pinning if there is more than one node, and prints the placement of the slots (or why nothing is pinned).
+   /// Returns whether pinning is enabled.
+   bool Enable(unsigned int nSlots);
+   bool Enabled() const { return fEnabled; }
+   /// Pins the calling thread to the core of the slot, returns false if this failed (which is only reported once) or
+   /// if the calling thread is the thread that called Enable.
+   bool Pin(unsigned int slot);
+
+private:
+   NumaTopology();
+
+   /// Converts a cpu list like "0-15,32-47" to the cpu numbers.
+   static std::vector<int> ParseList(const std::string& list);
+
+   std::vector<std::vector<int>> fCpus;   ///< cores of each node we are allowed to run on
+   bool                          fEnabled{false};
+   std::thread::id               fMainThread;      ///< thread that called Enable, which is never pinned
+   std::atomic<bool>             fFailed{false};   ///< whether pinning failed before
+};
+
+#endif
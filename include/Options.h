@@ -26,6 +26,32 @@ public:
 
    Calibration* GetCalibration() const { return fCalibration; }
 
+   bool Follow() const { return fFollow; }
+
+   std::string PerfReportFile() const { return fPerfReportFile; }
+
+   bool Profile() const { return fProfile; }
+
+   std::string MemoryPolicy() const { return fMemoryPolicy; }
+
+   bool Numa() const { return fNuma; }
+
+   bool ParallelUnzip() const { return fParallelUnzip; }
+
+   std::string MmapAdvice() const { return fMmapAdvice; }
+
+   std::string HistogramFile() const { return fHistogramFile; }
+
+   std::string DerivedCache() const { return fDerivedCache; }
+
+   std::string EntryList() const { return fEntryList; }
+
+   double MonitorInterval() const { return fMonitorInterval; }
+
+   bool   TimeRange() const { return fTimeRange; }
+   double TimeLow() const { return fTimeLow; }
+   double TimeHigh() const { return fTimeHigh; }
+
    // setters
    void Debug(bool debug)
    {
@@ -47,6 +73,35 @@ public:
 
    void Helper(const char* source) { fHelper = source; }
 
+   void Follow(bool follow) { fFollow = follow; }
+
+   void PerfReportFile(const char* file) { fPerfReportFile = file; }
+
+   void Profile(bool profile) { fProfile = profile; }
+
+   void MemoryPolicy(const char* policy) { fMemoryPolicy = policy; }
+
+   void Numa(bool numa) { fNuma = numa; }
+
+   void ParallelUnzip(bool parallelUnzip) { fParallelUnzip = parallelUnzip; }
+
+   void MmapAdvice(const char* advice) { fMmapAdvice = advice; }
+
+   void HistogramFile(const char* file) { fHistogramFile = file; }
+
+   void DerivedCache(const char* directory) { fDerivedCache = directory; }
+
+   void EntryList(const char* file) { fEntryList = file; }
+
+   void MonitorInterval(double seconds) { fMonitorInterval = seconds; }
+
+   void TimeRange(double low, double high)
+   {
+      fTimeRange = true;
+      fTimeLow   = low;
+      fTimeHigh  = high;
+   }
+
    void SetCalibration(const char* file)
    {
       delete fCalibration;
@@ -64,6 +119,32 @@ public:
       std::cout << "Running on " << fMaxWorkers << " workers" << std::endl;
       std::cout << "Got a run number string \"" << fRunNumberString << "\"" << std::endl;
       std::cout << "Using helper " << fHelper << std::endl;
+      std::cout << "Follow mode is" << (fFollow ? " " : " not ") << "enabled" << std::endl;
+      std::cout << "Profiling of the helper is" << (fProfile ? " " : " not ") << "enabled" << std::endl;
+      std::cout << "Using memory policy " << fMemoryPolicy << std::endl;
+      std::cout << "NUMA placement is" << (fNuma ? " " : " not ") << "enabled" << std::endl;
+      std::cout << "Parallel unzipping is" << (fParallelUnzip ? " " : " not ") << "enabled" << std::endl;
+      if(!fMmapAdvice.empty()) {
+         std::cout << "Mapping local input files with madvise hint " << fMmapAdvice << std::endl;
+      }
+      if(fMonitorInterval > 0.) {
+         std::cout << "Writing snapshots of the histograms every " << fMonitorInterval << " s" << std::endl;
+      }
+      if(fTimeRange) {
+         std::cout << "Only processing entries with an extended timestamp from " << fTimeLow << " to " << fTimeHigh << std::endl;
+      }
+      if(!fEntryList.empty()) {
+         std::cout << "Only processing the entries of the entry list in " << fEntryList << std::endl;
+      }
+      if(!fHistogramFile.empty()) {
+         std::cout << "Creating the histograms declared in " << fHistogramFile << std::endl;
+      }
+      if(!fDerivedCache.empty()) {
+         std::cout << "Using derived column cache in " << fDerivedCache << std::endl;
+      }
+      if(!fPerfReportFile.empty()) {
+         std::cout << "Writing performance report to " << fPerfReportFile << std::endl;
+      }
    }
 
 private:
@@ -102,12 +183,26 @@ private:
    }
 
    bool                     fDebug{false};
+   bool                     fFollow{false};
+   bool                     fProfile{false};
+   bool                     fNuma{false};
+   bool                     fParallelUnzip{false};
+   bool                     fTimeRange{false};
    std::vector<std::string> fInputFiles;
    std::string              fOutputFileName;
    std::string              fTreeName;
    std::string              fRunNumberString;
    std::string              fHelper;
+   std::string              fPerfReportFile;
+   std::string              fMemoryPolicy{"report"};
+   std::string              fDerivedCache;
+   std::string              fEntryList;
+   std::string              fHistogramFile;   ///< file with histogram definitions
+   std::string              fMmapAdvice;      ///< madvise hint for memory mapped input files, empty if they aren't mapped
    int                      fMaxWorkers{0};
+   double                   fMonitorInterval{0.};
+   double                   fTimeLow{0.};
+   double                   fTimeHigh{0.};
    class Calibration*       fCalibration{nullptr};
 };
 #endif
@@ -0,0 +1,72 @@
+#ifndef PERFREPORT_H
+#define PERFREPORT_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "TStopwatch.h"
+
+#include "Singleton.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class PerfReport
+///
+/// Collects wall and cpu times of the different phases of a run
+/// (chain open, helper compile/load, Setup, event loop, Finalize,
+/// output write), the number of events processed by each slot
+/// and the time it was busy, and the size of each output object.
+/// Everything is written as a machine-readable JSON file at the
+/// end of the run, together with the bytes read from the input
+/// files and the peak resident memory.
+/// Phases can be started and stopped multiple times (e.g. in
+/// follow mode), the times accumulate.
+///
+/////////////////////////////////////////////////////////////////
+
+class PerfReport : public Singleton<PerfReport> {
+public:
+   friend class Singleton<PerfReport>;
+
+   PerfReport(const PerfReport&)            = delete;
+   PerfReport(PerfReport&&)                 = delete;
+   PerfReport& operator=(const PerfReport&) = delete;
+   PerfReport& operator=(PerfReport&&)      = delete;
+   ~PerfReport()                            = default;
+
+   void Start(const std::string& phase);   ///< starts (or continues) the stopwatch of this phase
+   void Stop(const std::string& phase);    ///< stops the stopwatch of this phase (does nothing if it isn't running)
+
+   /// Adds the number of events processed by each slot and the time (in seconds) each slot was busy.
+   void AddSlotEvents(const std::vector<ULong64_t>& events, const std::vector<double>& busy);
+   void AddEvents(Long64_t events) { fEvents += events; }
+   /// Sets the (uncompressed) size of an output object per slot.
+   void ObjectSize(const std::string& name, Long64_t bytes, size_t slots)
+   {
+      fObjectSizes[name] = bytes;
+      fSlots             = slots;
+   }
+
+   void Write(const std::string& fileName);
+
+private:
+   PerfReport() = default;
+
+   size_t FindPhase(const std::string& phase) const;   ///< index of the phase (or the number of phases if it's new)
+
+   std::vector<std::string>        fPhases;        //!<! all phases in the order they were first started
+   std::vector<TStopwatch>         fWatches;       //!<! stopwatch of each phase
+   std::vector<bool>               fRunning;       //!<! whether the stopwatch of each phase is running
+   std::vector<ULong64_t>          fSlotEvents;    //!<! number of events processed by each slot
+   std::vector<double>             fSlotBusy;      //!<! time each slot was busy processing events
+   Long64_t                        fEvents{0};     //!<! number of entries processed
+   std::map<std::string, Long64_t> fObjectSizes;   //!<! size of each output object (per slot)
+   size_t                          fSlots{0};      //!<! number of slots each output object exists in
+
+   /// \cond CLASSIMP
+   ClassDefOverride(PerfReport, 1)   // NOLINT(readability-else-after-return)
+   /// \endcond
+};
+
+#endif
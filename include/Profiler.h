@@ -0,0 +1,169 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class Profiler
+///
+/// Low-overhead profiling of sections of helper code. Each
+/// section is timed with the time stamp counter of the CPU (or
+/// std::chrono::steady_clock on other architectures) and the
+/// times are accumulated in data that belongs to the slot running
+/// the section, so no locks or atomics are needed while the event
+/// loop runs (a slot is only ever used by one thread at a time,
+/// but one thread can run different slots). The data is reset at
+/// the start of each event loop. Nested sections are kept as a
+/// tree, so the results can also be written as folded stacks for
+/// flame graphs.
+///
+/// Sections and counters are used via the macros
+/// \code
+/// HIGS_PROFILE(slot, "addback");   // times the rest of the enclosing scope
+/// HIGS_COUNT(slot, "bad amplitude");   // increments a counter
+/// \endcode
+/// which only do something if the helper is compiled with
+/// HIGS_PROFILING defined (HigsFrame does this when run with
+/// --profile), otherwise they are empty and cost nothing.
+///
+/////////////////////////////////////////////////////////////////
+
+class Profiler {
+public:
+   /// Tree node of a section for one slot, the first node is the root of the tree.
+   struct Node {
+      size_t              fParent{0};
+      size_t              fSection{0};
+      uint64_t            fTicks{0};
+      uint64_t            fCalls{0};
+      std::vector<size_t> fChildren;
+   };
+
+   /// All data of one slot, only ever modified by the thread running the slot.
+   struct SlotData {
+      SlotData() { fNodes.emplace_back(); }
+
+      size_t Child(size_t parent, size_t section)
+      {
+         for(auto child : fNodes[parent].fChildren) {
+            if(fNodes[child].fSection == section) { return child; }
+         }
+         fNodes.emplace_back();
+         fNodes.back().fParent  = parent;
+         fNodes.back().fSection = section;
+         fNodes[parent].fChildren.push_back(fNodes.size() - 1);
+         return fNodes.size() - 1;
+      }
+      void Count(size_t counter)
+      {
+         if(counter >= fCounters.size()) { fCounters.resize(counter + 1, 0); }
+         ++fCounters[counter];
+      }
+
+      std::vector<Node>     fNodes;
+      std::vector<uint64_t> fCounters;
+      size_t                fCurrent{0};
+   };
+
+   static Profiler& Get();
+
+   Profiler(const Profiler&)            = delete;
+   Profiler(Profiler&&)                 = delete;
+   Profiler& operator=(const Profiler&) = delete;
+   Profiler& operator=(Profiler&&)      = delete;
+   ~Profiler()                          = default;
+
+   /// Returns the id of the section with this name (creating it if needed), called once per call site.
+   size_t RegisterSection(const char* name) { return Register(fSections, name); }
+   /// Returns the id of the counter with this name (creating it if needed), called once per call site.
+   size_t RegisterCounter(const char* name) { return Register(fCounters, name); }
+
+   /// Discards all data and creates empty data for each slot, called at the start of each event loop (in Initialize).
+   void Reset(unsigned int nSlots);
+   /// Returns the data of the slot.
+   SlotData& Slot(unsigned int slot) { return *fSlots[slot]; }
+
+   /// Time stamp counter (or nanoseconds), defined in the source file so that x86intrin.h isn't included by helpers.
+   static uint64_t Ticks();
+
+   /// True if any section or counter has been used.
+   bool Active() const { return !fSections.empty() || !fCounters.empty(); }
+
+   /// Prints the accumulated times and counters (and the fills of each histogram per slot), and writes the
+   /// folded stacks of all sections to <prefix>.folded (for e.g. flamegraph.pl).
+   void Report(const std::string& prefix, const std::map<std::string, std::vector<double>>& fills);
+
+private:
+   Profiler()
+      : fStartTicks(Ticks()), fStartTime(std::chrono::steady_clock::now())
+   {
+   }
+
+   size_t Register(std::vector<std::string>& names, const char* name);
+
+   std::mutex                             fMutex;
+   std::vector<std::string>               fSections;
+   std::vector<std::string>               fCounters;
+   std::vector<std::unique_ptr<SlotData>> fSlots;
+   uint64_t                               fStartTicks;
+   std::chrono::steady_clock::time_point  fStartTime;
+};
+
+/// Times the scope it lives in and adds it to the section tree of the slot.
+class ProfileScope {
+public:
+   ProfileScope(unsigned int slot, size_t section)
+      : fData(Profiler::Get().Slot(slot)), fParent(fData.fCurrent)
+   {
+      fNode          = fData.Child(fParent, section);
+      fData.fCurrent = fNode;
+      fStart         = Profiler::Ticks();
+   }
+   ~ProfileScope()
+   {
+      auto& node = fData.fNodes[fNode];
+      node.fTicks += Profiler::Ticks() - fStart;
+      ++node.fCalls;
+      fData.fCurrent = fParent;
+   }
+
+   ProfileScope(const ProfileScope&)            = delete;
+   ProfileScope(ProfileScope&&)                 = delete;
+   ProfileScope& operator=(const ProfileScope&) = delete;
+   ProfileScope& operator=(ProfileScope&&)      = delete;
+
+private:
+   Profiler::SlotData& fData;
+   size_t              fParent;
+   size_t              fNode{0};
+   uint64_t            fStart{0};
+};
+
+// NOLINTBEGIN(cppcoreguidelines-macro-usage)
+#ifdef HIGS_PROFILING
+#define HIGS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define HIGS_PROFILE_CONCAT(a, b) HIGS_PROFILE_CONCAT_IMPL(a, b)
+#define HIGS_PROFILE(slot, name)                                                                                  \
+   static const size_t HIGS_PROFILE_CONCAT(higsProfileSection, __LINE__) = Profiler::Get().RegisterSection(name); \
+   const ProfileScope  HIGS_PROFILE_CONCAT(higsProfileScope, __LINE__)(slot, HIGS_PROFILE_CONCAT(higsProfileSection, __LINE__))
+#define HIGS_COUNT(slot, name)                                                          \
+   do {                                                                                 \
+      static const size_t higsProfileCounter = Profiler::Get().RegisterCounter(name); \
+      Profiler::Get().Slot(slot).Count(higsProfileCounter);                             \
+   } while(false)
+#else
+#define HIGS_PROFILE(slot, name)
+#define HIGS_COUNT(slot, name) \
+   do {                        \
+   } while(false)
+#endif
+// NOLINTEND(cppcoreguidelines-macro-usage)
+
+#endif
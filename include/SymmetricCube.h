@@ -0,0 +1,117 @@
+#ifndef SYMMETRICCUBE_H
+#define SYMMETRICCUBE_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "TNamed.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TH3F.h"
+#include "TCollection.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class SymmetricCube
+///
+/// Symmetric (e.g. γγγ) cube that only stores the bins with
+/// i <= j <= k, so it needs a sixth of the memory of a TH3 and
+/// each triple of values is filled once instead of six times.
+/// All axes have the same binning, values outside of the range
+/// are ignored.
+///
+/// The content of the full cube is the same as that of a TH3
+/// filled with all permutations of (x, y, z), so bins with two
+/// equal indices contain each fill twice, and bins with three
+/// equal indices six times. Usually the cube is too large to be
+/// expanded, so the gated projections are the main output.
+///
+/////////////////////////////////////////////////////////////////
+
+class SymmetricCube : public TNamed {
+public:
+   SymmetricCube() = default;
+   SymmetricCube(const char* name, const char* title, int bins, double low, double high);
+
+   void Fill(double x, double y, double z, double weight = 1.)
+   {
+      int i = Bin(x);
+      int j = Bin(y);
+      int k = Bin(z);
+      if(i < 0 || j < 0 || k < 0) { return; }
+      // sort the three bins so that i <= j <= k
+      if(i > j) { std::swap(i, j); }
+      if(j > k) { std::swap(j, k); }
+      if(i > j) { std::swap(i, j); }
+      fData[Index(i, j, k)] += static_cast<float>(weight);
+   }
+
+   /// Content of bin (i, j, k) of the full cube (bins start at 0).
+   double Get(int i, int j, int k) const
+   {
+      if(i > j) { std::swap(i, j); }
+      if(j > k) { std::swap(j, k); }
+      if(i > j) { std::swap(i, j); }
+      return Multiplicity(i, j, k) * fData[Index(i, j, k)];
+   }
+   /// Adds content to bin (i, j, k) of the full cube (and thus all its permutations), so Get(i, j, k) increases by content.
+   void AddBinContent(int i, int j, int k, double content)
+   {
+      if(i > j) { std::swap(i, j); }
+      if(j > k) { std::swap(j, k); }
+      if(i > j) { std::swap(i, j); }
+      fData[Index(i, j, k)] += static_cast<float>(content / Multiplicity(i, j, k));
+   }
+
+   int    Bins() const { return fBins; }
+   double Low() const { return fLow; }
+   double High() const { return fHigh; }
+   /// Memory used by the stored bins (in bytes).
+   size_t Bytes() const { return fData.size() * sizeof(float); }
+   /// Memory a TH3F with the same binning would need (in bytes).
+   size_t ExpandedBytes() const { return static_cast<size_t>(fBins + 2) * (fBins + 2) * (fBins + 2) * sizeof(float); }
+
+   /// Adds the content of another cube with the same binning.
+   void     Add(const SymmetricCube* other);
+   Long64_t Merge(TCollection* list);
+   void     Reset(Option_t* = "") { std::fill(fData.begin(), fData.end(), 0.F); }
+
+   /// Creates the full cube as TH3F (the caller owns it).
+   TH3F* Expand() const;
+   /// Matrix of the full cube gated on [low, high] on one axis (the caller owns it).
+   TH2D* Project(double low, double high) const;
+   /// Spectrum of the full cube gated on [low1, high1] on one axis and [low2, high2] on another (the caller owns it).
+   TH1D* Project(double low1, double high1, double low2, double high2) const;
+
+private:
+   int Bin(double val) const
+   {
+      if(!(val >= fLow && val < fHigh)) { return -1; }   // also true for NaN
+      // values just below fHigh can end up in bin fBins due to rounding
+      return std::min(static_cast<int>((val - fLow) * fScale), fBins - 1);
+   }
+   /// How often a fill of the sorted bins i <= j <= k appears in the full cube bin (i, j, k).
+   static double Multiplicity(int i, int j, int k)
+   {
+      if(i == k) { return 6.; }
+      if(i == j || j == k) { return 2.; }
+      return 1.;
+   }
+   /// Range of bins [first, last] overlapping with [low, high].
+   std::pair<int, int> Gate(double low, double high) const;
+   static size_t       Index(int i, int j, int k)
+   {
+      return static_cast<size_t>(k) * (k + 1) * (k + 2) / 6 + static_cast<size_t>(j) * (j + 1) / 2 + i;
+   }
+
+   int                fBins{0};
+   double             fLow{0.};
+   double             fHigh{0.};
+   double             fScale{0.};   ///< bins per unit
+   std::vector<float> fData;
+
+   ClassDefOverride(SymmetricCube, 1);   // NOLINT(readability-else-after-return)
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SYMMETRICMATRIX_H
+#define SYMMETRICMATRIX_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "TNamed.h"
+#include "TH1D.h"
+#include "TH2F.h"
+#include "TCollection.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class SymmetricMatrix
+///
+/// Symmetric (e.g. γγ) matrix that only stores the bins with
+/// i <= j, so it needs half the memory of a TH2 and each pair
+/// of values is filled once instead of twice. Both axes have
+/// the same binning, values outside of the range are ignored.
+///
+/// The full matrix is only created on output (Expand), it is
+/// the same as a TH2 filled with both (x, y) and (y, x), i.e.
+/// the diagonal contains each fill twice.
+///
+/// Matrices in fGG of BasicHelper are merged in Finalize, and
+/// are written as TH2F.
+///
+/////////////////////////////////////////////////////////////////
+
+class SymmetricMatrix : public TNamed {
+public:
+   SymmetricMatrix() = default;
+   SymmetricMatrix(const char* name, const char* title, int bins, double low, double high);
+
+   void Fill(double x, double y, double weight = 1.)
+   {
+      int i = Bin(x);
+      int j = Bin(y);
+      if(i < 0 || j < 0) { return; }
+      if(i > j) { std::swap(i, j); }
+      fData[Index(i, j)] += static_cast<float>(weight);
+   }
+
+   /// Content of bin (i, j) of the full matrix (bins start at 0).
+   double Get(int i, int j) const
+   {
+      if(i > j) { std::swap(i, j); }
+      return (i == j ? 2. : 1.) * fData[Index(i, j)];
+   }
+
+   int    Bins() const { return fBins; }
+   double Low() const { return fLow; }
+   double High() const { return fHigh; }
+   /// Memory used by the stored bins (in bytes).
+   size_t Bytes() const { return fData.size() * sizeof(float); }
+
+   /// Adds the content of another matrix with the same binning.
+   void     Add(const SymmetricMatrix* other);
+   Long64_t Merge(TCollection* list);
+   void     Reset(Option_t* = "") { std::fill(fData.begin(), fData.end(), 0.F); }
+
+   /// Creates the full matrix as TH2F (the caller owns it).
+   TH2F* Expand() const;
+   /// Projection of the full matrix gated on [low, high] on one axis (the caller owns it).
+   TH1D* Project(double low, double high) const;
+
+private:
+   int Bin(double val) const
+   {
+      if(!(val >= fLow && val < fHigh)) { return -1; }   // also true for NaN
+      // values just below fHigh can end up in bin fBins due to rounding
+      return std::min(static_cast<int>((val - fLow) * fScale), fBins - 1);
+   }
+   static size_t Index(int i, int j) { return static_cast<size_t>(j) * (j + 1) / 2 + i; }
+
+   int                fBins{0};
+   double             fLow{0.};
+   double             fHigh{0.};
+   double             fScale{0.};   ///< bins per unit
+   std::vector<float> fData;
+
+   ClassDefOverride(SymmetricMatrix, 1);   // NOLINT(readability-else-after-return)
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef TILEDHISTOGRAM_H
+#define TILEDHISTOGRAM_H
+
+#include <vector>
+#include <string>
+
+#include "TNamed.h"
+#include "TH1.h"
+#include "TH1D.h"
+#include "TDirectory.h"
+
+class SymmetricCube;
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TiledHistogram
+///
+/// Writes a histogram that is too large to be written as one
+/// object (more than 1 GB) as slabs of x-bins ("tiles"), each of
+/// which is a normal histogram of the same class named
+/// <name>_tile<n>, plus this object as descriptor with the name
+/// of the histogram. The tiles are created and written one at a
+/// time, so only one tile is in memory in addition to the
+/// histogram.
+///
+/// Read back from file, this object gives access to slices and
+/// projections without loading the whole histogram, only the
+/// tiles that are needed are read (one at a time):
+/// \code
+/// auto* tiled = file.Get<TiledHistogram>("ggPrompt");
+/// tiled->SetDirectory(&file);
+/// TH1D* gated = tiled->ProjectionY(tiled->FindBin(1332.), tiled->FindBin(1333.));
+/// \endcode
+///
+/// BasicHelper::CheckSizes replaces histograms and symmetric cubes
+/// that are too large with a TiledHistogram in the output list,
+/// which then owns them. The tiles of a cube are slabs of the full
+/// cube (TH3F), created from the compressed cube one at a time.
+///
+/////////////////////////////////////////////////////////////////
+
+class TiledHistogram : public TNamed {
+public:
+   static constexpr Long64_t kTileSize = 268435456;   ///< target size of each tile (256 MB)
+
+   /// Estimated size of the histogram in bytes (bin contents and errors).
+   static Long64_t Size(const TH1* hist);
+
+   TiledHistogram() = default;
+   /// Creates the descriptor of the histogram, and takes ownership of it (the histogram isn't copied).
+   explicit TiledHistogram(TH1* hist);
+   /// Creates the descriptor of the full cube (TH3F), and takes ownership of the cube.
+   explicit TiledHistogram(SymmetricCube* cube);
+   TiledHistogram(const TiledHistogram&)            = delete;
+   TiledHistogram(TiledHistogram&&)                 = delete;
+   TiledHistogram& operator=(const TiledHistogram&) = delete;
+   TiledHistogram& operator=(TiledHistogram&&)      = delete;
+   ~TiledHistogram() override;
+
+   /// Writes all tiles and then this descriptor to the current directory.
+   Int_t Write(const char* name = nullptr, Int_t option = 0, Int_t bufsize = 0) override;
+   Int_t Write(const char* name = nullptr, Int_t option = 0, Int_t bufsize = 0) const override;
+   /// Adds the tiles of an existing tiled histogram with the same name in the directory to the histogram (when merging
+   /// into an existing output file). Returns false if there is none or its binning is different.
+   bool AddExisting(TDirectory* directory);
+
+   /// Sets the directory the tiles are read from.
+   void  SetDirectory(TDirectory* directory) { fDirectory = directory; }
+   int   Dimension() const { return fDimension; }
+   int   Tiles() const { return static_cast<int>(fFirstBin.size()) - 1; }
+   int   NbinsX() const { return static_cast<int>(fXEdges.size()) - 1; }
+   int   FindBin(double x) const;
+   /// Reads the tile from the directory (the caller owns it).
+   TH1* Tile(int tile) const;
+   /// Histogram of x-bins firstBin to lastBin (1 to NbinsX) with all other axes, the caller owns it.
+   TH1* Slice(int firstBin, int lastBin) const;
+   /// Projection onto the x-axis (the caller owns it).
+   TH1D* ProjectionX() const;
+   /// Projection onto the y-axis of x-bins firstBin to lastBin (the caller owns it).
+   TH1D* ProjectionY(int firstBin, int lastBin) const;
+
+private:
+   /// Splits the x-axis into tiles of about kTileSize bytes.
+   void Split(Long64_t bytesPerCell);
+   /// Creates an empty histogram of the original class with x-bins firstBin to lastBin.
+   TH1* Create(const char* name, int firstBin, int lastBin) const;
+   /// Fills the tile with x-bins firstBin to lastBin from the cube.
+   void FillFromCube(TH1* tile, int firstBin, int lastBin) const;
+   /// Adds the tile with x-bins firstBin to lastBin to the cube (each bin of the cube only once).
+   void AddToCube(const TH1* tile, int firstBin, int lastBin);
+   /// Index of the tile that contains x-bin bin.
+   int TileOf(int bin) const;
+   int Cells(int axis) const;
+
+   std::string              fClassName;
+   int                      fDimension{0};
+   bool                     fSumw2{false};
+   double                   fEntries{0.};
+   std::vector<double>      fXEdges;
+   std::vector<double>      fYEdges;
+   std::vector<double>      fZEdges;
+   std::vector<std::string> fAxisTitles;
+   std::vector<int>         fFirstBin;   ///< first x-bin of each tile (with the first bin after the last tile at the end)
+
+   TH1*           fSource{nullptr};      //!<! histogram the tiles are created from (only when writing)
+   SymmetricCube* fCube{nullptr};        //!<! cube the tiles are created from (only when writing)
+   TDirectory*    fDirectory{nullptr};   //!<! directory the tiles are read from
+
+   ClassDefOverride(TiledHistogram, 1);   // NOLINT(readability-else-after-return)
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef ZONEMAP_H
+#define ZONEMAP_H
+
+#include <vector>
+#include <string>
+
+#include "TNamed.h"
+#include "TTree.h"
+#include "TEntryList.h"
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class ZoneMap
+///
+/// Minimum and maximum of some scalar columns (e.g.
+/// extended_timestamp) for each cluster of a tree. It is built
+/// once by reading only these columns, and stored next to the
+/// input file as <input>.zonemap.root.
+///
+/// To select entries with a value of a column within a range,
+/// clusters whose range doesn't overlap with it are skipped
+/// without reading them, clusters that are completely inside
+/// the range are selected without reading them, and only the
+/// clusters at the edges of the range (or with NaN values, which
+/// are never selected) are read to select the individual entries.
+///
+/// \code
+/// auto* zoneMap = ZoneMap::ForFile(file, "higs_data", {"extended_timestamp"});
+/// TEntryList list("", "", "higs_data", file.c_str());
+/// ZoneMap::Counts counts;
+/// zoneMap->Select(tree, "extended_timestamp", low, high, list, counts);
+/// \endcode
+///
+/////////////////////////////////////////////////////////////////
+
+class ZoneMap : public TNamed {
+public:
+   static constexpr const char* kName = "zonemap";
+
+   /// Number of clusters that were skipped, selected completely, or read by Select.
+   struct Counts {
+      Long64_t fSkipped{0};
+      Long64_t fComplete{0};
+      Long64_t fRead{0};
+   };
+
+   ZoneMap() = default;
+   /// Builds the zone map of the columns of the tree, reading only these columns.
+   ZoneMap(TTree* tree, const std::vector<std::string>& columns);
+
+   /// Reads the zone map of the input file from <input>.zonemap.root, or builds it (and tries to write it there) if it
+   /// doesn't exist, is out of date, or doesn't have all columns. The caller owns the zone map.
+   static ZoneMap* ForFile(const std::string& file, const std::string& treeName, const std::vector<std::string>& columns);
+   /// Name of the file the zone map of the input file is stored in.
+   static std::string FileName(const std::string& file);
+
+   size_t   Clusters() const { return fFirstEntry.empty() ? 0 : fFirstEntry.size() - 1; }
+   Long64_t Entries() const { return fFirstEntry.empty() ? 0 : fFirstEntry.back(); }
+   /// First entry of the cluster, and first entry after it.
+   Long64_t First(size_t cluster) const { return fFirstEntry[cluster]; }
+   Long64_t End(size_t cluster) const { return fFirstEntry[cluster + 1]; }
+   /// Index of the column, -1 if the zone map doesn't have it.
+   int    Column(const std::string& column) const;
+   double Min(size_t cluster, int column) const { return fMin[cluster * fColumns.size() + column]; }
+   double Max(size_t cluster, int column) const { return fMax[cluster * fColumns.size() + column]; }
+   /// Whether any value of the column in the cluster is NaN (these are not part of the minimum and maximum).
+   bool HasNaN(size_t cluster, int column) const { return fHasNaN[cluster * fColumns.size() + column] != 0; }
+   /// Whether the zone map has all information of the current version (zone maps written by older versions don't).
+   bool Complete() const { return fHasNaN.size() == fMin.size(); }
+
+   /// Adds all entries of the tree (which this zone map belongs to) with low <= column <= high to the list.
+   void Select(TTree* tree, const std::string& column, double low, double high, TEntryList& list, Counts& counts) const;
+
+private:
+   std::vector<std::string> fColumns;
+   std::vector<Long64_t>    fFirstEntry;   ///< first entry of each cluster, with the number of entries at the end
+   std::vector<double>      fMin;          ///< minimum of each cluster and column (NaN values are ignored)
+   std::vector<double>      fMax;          ///< maximum of each cluster and column (NaN values are ignored)
+   std::vector<char>        fHasNaN;       ///< whether any value of each cluster and column is NaN
+
+   ClassDefOverride(ZoneMap, 2);   // NOLINT(readability-else-after-return)
+};
+
+#endif
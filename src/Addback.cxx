@@ -0,0 +1,153 @@
+#include "Addback.h"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+#include "Globals.h"
+
+Addback::Addback(size_t crystals, size_t crystalsPerClover)
+{
+   if(crystalsPerClover == 0) {
+      throw std::runtime_error("Addback needs at least one crystal per clover!");
+   }
+   std::vector<size_t> clover(crystals);
+   for(size_t crystal = 0; crystal < crystals; ++crystal) {
+      clover[crystal] = crystal / crystalsPerClover;
+   }
+   SetGeometry(clover);
+}
+
+Addback::Addback(const std::vector<size_t>& clover)
+{
+   SetGeometry(clover);
+}
+
+void Addback::SetGeometry(const std::vector<size_t>& clover)
+{
+   size_t clovers = clover.empty() ? 0 : *std::max_element(clover.begin(), clover.end()) + 1;
+   fCloverCrystals.assign(clovers, {});
+   fCrystalClover.resize(clover.size());
+   fCrystalBit.resize(clover.size());
+   for(size_t crystal = 0; crystal < clover.size(); ++crystal) {
+      auto& crystals = fCloverCrystals[clover[crystal]];
+      if(crystals.size() >= 32) {
+         std::ostringstream str;
+         str << DRED << "Clover " << clover[crystal] << " has more than 32 crystals, addback can't handle that!" << RESET_COLOR;
+         throw std::runtime_error(str.str());
+      }
+      fCrystalClover[crystal] = static_cast<uint16_t>(clover[crystal]);
+      fCrystalBit[crystal]    = static_cast<uint8_t>(crystals.size());
+      crystals.push_back(crystal);
+   }
+   // by default all crystals of a clover are neighbours
+   fNeighbourMask.resize(clover.size());
+   for(size_t crystal = 0; crystal < clover.size(); ++crystal) {
+      fNeighbourMask[crystal] = static_cast<uint32_t>((1ULL << fCloverCrystals[clover[crystal]].size()) - 1);
+   }
+   fHitMask.assign(clovers, 0);
+   fCloverSum.assign(clovers, 0.);
+}
+
+void Addback::Neighbours(size_t crystal, const std::vector<size_t>& neighbours)
+{
+   fNeighbourMask.at(crystal) = 1U << fCrystalBit[crystal];
+   for(auto neighbour : neighbours) {
+      if(fCrystalClover.at(neighbour) == fCrystalClover[crystal]) {
+         fNeighbourMask[crystal] |= 1U << fCrystalBit[neighbour];
+      }
+   }
+   fNeighboursOnly = true;
+}
+
+void Addback::SquareNeighbours()
+{
+   for(size_t crystal = 0; crystal < fCrystalBit.size(); ++crystal) {
+      const auto& crystals = fCloverCrystals[fCrystalClover[crystal]];
+      if(crystals.size() != 4) { continue; }
+      auto bit = fCrystalBit[crystal];
+      Neighbours(crystal, {crystals[(bit + 1) & 3U], crystals[(bit + 3) & 3U]});
+   }
+}
+
+void Addback::Process(const ROOT::RVecD& energy, const ROOT::RVecD& time)
+{
+   fEnergy.clear();
+   fTime.clear();
+   fClover.clear();
+   fMultiplicity.clear();
+
+   const size_t crystals = std::min(energy.size(), fCrystalClover.size());
+   const bool   simple   = !fNeighboursOnly && (fTimeGate <= 0. || time.size() < crystals);
+
+   // first pass: bit mask of hit crystals per clover, and the sum of all energies per clover if that's all we need
+   std::fill(fHitMask.begin(), fHitMask.end(), 0U);
+   std::fill(fCloverSum.begin(), fCloverSum.end(), 0.);
+   for(size_t crystal = 0; crystal < crystals; ++crystal) {
+      // NaN fails the comparison, so this also removes crystals without a hit
+      bool hit = energy[crystal] > fThreshold;
+      fHitMask[fCrystalClover[crystal]] |= static_cast<uint32_t>(hit) << fCrystalBit[crystal];
+      fCloverSum[fCrystalClover[crystal]] += hit ? energy[crystal] : 0.;
+   }
+
+   // second pass: addback hits from the masks
+   for(size_t clover = 0; clover < fHitMask.size(); ++clover) {
+      uint32_t remaining = fHitMask[clover];
+      if(remaining == 0) { continue; }
+      const auto& cloverCrystals = fCloverCrystals[clover];
+      if(simple) {
+         // the crystal with the highest energy provides the time
+         double highest = 0.;
+         double hitTime = NAN;
+         for(uint32_t mask = remaining; mask != 0; mask &= mask - 1) {
+            auto crystal = cloverCrystals[__builtin_ctz(mask)];
+            if(energy[crystal] > highest) {
+               highest = energy[crystal];
+               hitTime = crystal < time.size() ? time[crystal] : NAN;
+            }
+         }
+         fEnergy.push_back(fCloverSum[clover]);
+         fTime.push_back(hitTime);
+         fClover.push_back(clover);
+         fMultiplicity.push_back(static_cast<uint8_t>(__builtin_popcount(remaining)));
+         continue;
+      }
+      while(remaining != 0) {
+         // the seed is the remaining crystal with the highest energy
+         size_t seed = cloverCrystals[__builtin_ctz(remaining)];
+         for(uint32_t mask = remaining; mask != 0; mask &= mask - 1) {
+            auto crystal = cloverCrystals[__builtin_ctz(mask)];
+            if(energy[crystal] > energy[seed]) { seed = crystal; }
+         }
+         // crystals that can be added are those within the time gate of the seed
+         uint32_t candidates = remaining;
+         if(fTimeGate > 0. && time.size() >= crystals) {
+            for(uint32_t mask = remaining; mask != 0; mask &= mask - 1) {
+               auto crystal = cloverCrystals[__builtin_ctz(mask)];
+               if(!(std::abs(time[crystal] - time[seed]) <= fTimeGate)) { candidates &= ~(1U << fCrystalBit[crystal]); }
+            }
+         }
+         // grow the cluster from the seed via the neighbours until nothing changes anymore
+         uint32_t cluster = 1U << fCrystalBit[seed];
+         uint32_t added   = cluster;
+         while(added != 0) {
+            uint32_t reach = 0;
+            for(uint32_t mask = added; mask != 0; mask &= mask - 1) {
+               reach |= fNeighbourMask[cloverCrystals[__builtin_ctz(mask)]];
+            }
+            added = reach & candidates & ~cluster;
+            cluster |= added;
+         }
+         double sum = 0.;
+         for(uint32_t mask = cluster; mask != 0; mask &= mask - 1) {
+            sum += energy[cloverCrystals[__builtin_ctz(mask)]];
+         }
+         fEnergy.push_back(sum);
+         fTime.push_back(seed < time.size() ? time[seed] : NAN);
+         fClover.push_back(clover);
+         fMultiplicity.push_back(static_cast<uint8_t>(__builtin_popcount(cluster)));
+         remaining &= ~cluster;
+      }
+   }
+}
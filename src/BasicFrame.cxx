@@ -2,16 +2,93 @@
 #include "RVersion.h"
 
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <memory>
+#include <csignal>
+#include <climits>
+#include <cstdlib>
+#include <chrono>
+#include <utility>
 
 #include "TFile.h"
 #include "TChain.h"
+#include "TEntryList.h"
+#include "TChainElement.h"
+#include "TTreeCacheUnzip.h"
 #include "ROOT/RDataFrame.hxx"
 #include "ROOT/RDFHelpers.hxx"
 
 #include "DataFrameLibrary.h"
 #include "CustomMap.h"
+#include "FileWatcher.h"
+#include "PerfReport.h"
+#include "Logger.h"
+#include "TiledHistogram.h"
+#include "MemoryPlanner.h"
+#include "DerivedCache.h"
+#include "BasicHelper.h"
+#include "ZoneMap.h"
+#include "MappedFile.h"
+
+namespace {
+std::string CanonicalPath(const std::string& path)
+{
+   /// returns the absolute path without symbolic links, or the path itself if that fails
+   std::array<char, PATH_MAX> buffer{};
+   if(realpath(path.c_str(), buffer.data()) == nullptr) {
+      return path;
+   }
+   return buffer.data();
+}
+
+/// Counts the events and measures the busy time of each slot for the performance report. A task is timed from its
+/// start (InitTask) to the last event of it, so the time a slot waits for its next task isn't counted.
+class SlotTimes : public ROOT::Detail::RDF::RActionImpl<SlotTimes> {
+public:
+   using Result_t = std::vector<std::pair<ULong64_t, double>>;   ///< number of events and busy time in seconds of each slot
+
+   explicit SlotTimes(unsigned int nSlots)
+      : fSlots(nSlots), fResult(std::make_shared<Result_t>())
+   {
+   }
+
+   std::shared_ptr<Result_t> GetResultPtr() const { return fResult; }
+   std::string               GetActionName() const { return "SlotTimes"; }
+
+   void Initialize() {}
+   void InitTask(TTreeReader*, unsigned int slot) { fSlots[slot].fLast = std::chrono::steady_clock::now(); }
+   void Exec(unsigned int slot, ULong64_t /*entry*/)
+   {
+      auto  now  = std::chrono::steady_clock::now();
+      auto& time = fSlots[slot];
+      time.fBusy += now - time.fLast;
+      time.fLast = now;
+      ++time.fEvents;
+   }
+   void Finalize()
+   {
+      for(const auto& time : fSlots) {
+         fResult->emplace_back(time.fEvents, std::chrono::duration<double>(time.fBusy).count());
+      }
+   }
+
+private:
+   /// one cache line per slot, so the slots don't invalidate each other's counters
+   struct alignas(64) Slot {
+      std::chrono::steady_clock::time_point fLast;
+      std::chrono::steady_clock::duration   fBusy{0};
+      ULong64_t                             fEvents{0};
+   };
+
+   std::vector<Slot>         fSlots;
+   std::shared_ptr<Result_t> fResult;
+};
+}   // namespace
 
 // This assumes the options have been set from argc and argv before! That's true when using grsiframe, other programs need to ensure this happens.
 BasicFrame::BasicFrame(Options* opt)
@@ -28,67 +105,375 @@ BasicFrame::BasicFrame(Options* opt)
    }
 #endif
 
-   std::string treeName = fOptions->TreeName();
-   if(treeName.empty()) {
+   fTreeName = fOptions->TreeName();
+   if(fTreeName.empty()) {
       TFile check(fOptions->InputFiles()[0].c_str());
       if(check.Get("higs_data") != nullptr) {
-         treeName = "higs_data";
+         fTreeName = "higs_data";
       }
       check.Close();
    }
-   if(treeName.empty()) {
+   if(fTreeName.empty()) {
       std::ostringstream str;
       str << "Failed to find 'higs_data' in '" << fOptions->InputFiles()[0] << "', either provide a different tree name via --tree-name flag or check input file" << std::endl;
       throw std::runtime_error(str.str());
    }
 
+   // create an input list to pass to the helper
+   fInputList = new TList;
+
+   fInputList->Add(fOptions->GetCalibration());
+
+   // estimate the memory needed before any slots are created, this can reduce the number of workers
+   PlanMemory();
+
    // only enable multi threading if number of threads isn't zero
    if(fOptions->MaxWorkers() > 0) {
       ROOT::EnableImplicitMT(fOptions->MaxWorkers());
    }
 
-   auto* chain = new TChain(treeName.c_str());
+   // the tree cache of each task then unzips the baskets it prefetched in the background, using the thread pool
+   if(fOptions->ParallelUnzip()) {
+      TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+   }
 
-   // loop over input files, and add them to the chain
-   for(const auto& fileName : fOptions->InputFiles()) {
-      if(chain->Add(fileName.c_str(), 0) < 1) {   // setting nentries parameter to zero makes TChain load the file header and return a 1 if the file was opened successfully
-         std::cout << "Failed to open '" << fileName << "'" << std::endl;
-      }
+   if(!fOptions->MmapAdvice().empty()) {
+      MappedFile::Enable(fOptions->MmapAdvice());
    }
 
-   std::cout << "Looped over " << chain->GetNtrees() << "/" << fOptions->InputFiles().size() << " files." << std::endl;
+   fFiles = fOptions->InputFiles();
 
-   fTotalEntries = chain->GetEntries();
+   Book(fFiles);
+}
 
-   fDataFrame = new ROOT::RDataFrame(*chain);
+void BasicFrame::PlanMemory()
+{
+   /// Creates the helper with a single slot (multi threading isn't enabled yet) to estimate the memory of one slot,
+   /// and applies the memory policy for the number of workers requested.
+   PerfReport::Get()->Start("memory planning");
+   auto          policy = MemoryPlanner::Policy(fOptions->MemoryPolicy());
+   MemoryPlanner planner;
+   auto*         helper = DataFrameLibrary::Get()->CreateHelper(fInputList);
+   planner.Estimate(helper->Prototype(), helper->LazySlots());
+   // the helper doesn't own its output objects (and only deletes the prototype in Finalize), so we delete them here
+   for(auto& list : helper->Prototype()) {
+      list.second.Delete();
+   }
+   DataFrameLibrary::Get()->DestroyHelper(helper);
 
-   // create an input list to pass to the helper
-   auto* inputList = new TList;
+   int workers = planner.Plan(std::max(fOptions->MaxWorkers(), 1), policy);
+   if(fOptions->MaxWorkers() > 0) {
+      fOptions->MaxWorkers(workers);
+   }
+   PerfReport::Get()->Stop("memory planning");
+}
 
-   inputList->Add(fOptions->GetCalibration());
+void BasicFrame::Book(const std::vector<std::string>& files)
+{
+   /// Creates a new chain and data frame from the files, and books a new helper on them.
+   /// In follow mode only entries that haven't been processed yet (according to the ledger) are added.
+
+   // reset the previous pass (if there was one), the result pointer needs to go before the data frame, and the data frame before the chain
+   fOutput = ROOT::RDF::RResultPtr<std::map<std::string, TList>>();
+   delete fDataFrame;
+   fDataFrame = nullptr;
+   delete fMapped;
+   fMapped = nullptr;
+   delete fChain;
+   delete fFriend;
+   fFriend = nullptr;
+   fPending.clear();
 
    /// Try to load an external library with the correct function in it.
    /// If that library does not exist, try to compile it.
    /// To handle all that we use the class DataFrameLibrary (very similar to TParserLibrary)
-   auto* helper  = DataFrameLibrary::Get()->CreateHelper(inputList);
+   auto* helper  = DataFrameLibrary::Get()->CreateHelper(fInputList);
    fOutputPrefix = helper->Prefix();
+
+   // in follow mode the output file name is fixed by the first pass, and the ledger lives next to it
+   if(fOptions->Follow() && fLedgerFileName.empty()) {
+      fOutputFileName = Form("%s%s.root", fOutputPrefix.c_str(), fOptions->RunNumberString().c_str());
+      fLedgerFileName = Form("%s%s.processed", fOutputPrefix.c_str(), fOptions->RunNumberString().c_str());
+      ReadLedger();
+   }
+
+   PerfReport::Get()->Start("chain open");
+   fChain = new TChain(fTreeName.c_str());
+
+   // only used in follow mode, first entry to process and number of entries of each file
+   std::vector<std::tuple<std::string, Long64_t, Long64_t>> ranges;
+   bool                                                     partialFiles = false;
+
+   // loop over input files, and add them to the chain
+   for(const auto& fileName : files) {
+      if(!fOptions->Follow()) {
+         if(fChain->Add(fileName.c_str(), 0) < 1) {   // setting nentries parameter to zero makes TChain load the file header and return a 1 if the file was opened successfully
+            std::cout << "Failed to open '" << fileName << "'" << std::endl;
+         }
+         continue;
+      }
+      // in follow mode we check how many entries we've already processed for this file
+      Long64_t entries = 0;
+      {
+         TFile file(fileName.c_str());
+         auto* tree = dynamic_cast<TTree*>(file.Get(fTreeName.c_str()));
+         if(tree == nullptr) {
+            std::cout << "Failed to find tree '" << fTreeName << "' in '" << fileName << "'" << std::endl;
+            continue;
+         }
+         entries = tree->GetEntries();
+      }
+      std::string canonicalName = CanonicalPath(fileName);
+      Long64_t    processed     = (fProcessed.count(canonicalName) == 1 ? fProcessed.at(canonicalName) : 0);
+      if(entries < processed) {
+         std::cout << DRED << "'" << fileName << "' has " << entries << " entries, but we already processed " << processed << " entries, skipping it!" << RESET_COLOR << std::endl;
+         continue;
+      }
+      if(entries == processed) {
+         continue;
+      }
+      if(processed > 0) {
+#if ROOT_VERSION_CODE < ROOT_VERSION(6, 28, 0)
+         std::cout << DRED << "'" << fileName << "' grew from " << processed << " to " << entries << " entries, but processing part of a file needs at least ROOT 6.28, skipping it!" << RESET_COLOR << std::endl;
+         continue;
+#else
+         std::cout << "'" << fileName << "' grew from " << processed << " to " << entries << " entries" << std::endl;
+         partialFiles = true;
+#endif
+      }
+      fChain->Add(fileName.c_str(), entries);
+      ranges.emplace_back(fileName, processed, entries);
+      fPending[canonicalName] = entries;
+   }
+
+   if(partialFiles) {
+      // once one file is only partially processed, all files need an entry list
+      auto* entryList = new TEntryList("", "");
+      for(const auto& range : ranges) {
+         TEntryList fileList("", "", fTreeName.c_str(), std::get<0>(range).c_str());
+         for(Long64_t entry = std::get<1>(range); entry < std::get<2>(range); ++entry) {
+            fileList.Enter(entry);
+         }
+         entryList->Add(&fileList);
+      }
+      fChain->SetEntryList(entryList);
+      fTotalEntries = entryList->GetN();
+   } else if(!fOptions->EntryList().empty()) {
+      fTotalEntries = ApplyEntryList();
+   } else if(fOptions->TimeRange()) {
+      fTotalEntries = ApplyTimeRange();
+   } else {
+      fTotalEntries = fChain->GetEntries();
+   }
+
+   if(fOptions->MaxWorkers() > 0 && !(fOptions->Follow() && fPending.empty())) {
+      ReportClusters();
+   }
+
+   PerfReport::Get()->Stop("chain open");
+
+   // in follow mode the ledger can show that there is nothing new, then there is nothing to book (or run and write)
+   if(fOptions->Follow() && fPending.empty()) {
+      std::cout << "All entries of the " << files.size() << " file(s) have already been processed, nothing to do" << std::endl;
+      DataFrameLibrary::Get()->DestroyHelper(helper);
+      fTotalEntries = 0;
+      return;
+   }
+
+   if(!fOptions->DerivedCache().empty()) {
+      AddDerivedColumns();
+   }
+
+   std::cout << "Looped over " << fChain->GetNtrees() << "/" << files.size() << " files, got " << fTotalEntries << " entries to process." << std::endl;
+
+   if(!fOptions->MmapAdvice().empty()) {
+      MapChain();
+   }
+
+   fDataFrame = new ROOT::RDataFrame(fMapped != nullptr ? *fMapped : *fChain);
+
    // this actually moves the helper to the data frame, so from here on "helper" doesn't refer to the object we created anymore
    // aka don't use helper after this!
    fOutput = helper->Book(fDataFrame);
 }
 
+Long64_t BasicFrame::ApplyEntryList()
+{
+   /// Restricts the chain to the entries of the entry list written by a helper that selected entries, and returns the
+   /// number of entries left. Clusters without any selected entries are never loaded, the number of clusters that are
+   /// skipped is reported.
+   TFile file(fOptions->EntryList().c_str());
+   auto* list = dynamic_cast<TEntryList*>(file.Get(BasicHelper::kEntryListName));
+   if(list == nullptr) {
+      std::ostringstream str;
+      str << DRED << "Failed to find entry list '" << BasicHelper::kEntryListName << "' in '" << fOptions->EntryList() << "'!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   list = static_cast<TEntryList*>(list->Clone());
+   list->SetDirectory(nullptr);
+   file.Close();
+   fChain->SetEntryList(list);
+
+   Long64_t selected = 0;
+   Long64_t clusters = 0;
+   Long64_t used     = 0;
+   for(const auto&& obj : *fChain->GetListOfFiles()) {
+      auto* element = static_cast<TChainElement*>(obj);
+      auto* sublist = list->GetEntryList(fTreeName.c_str(), element->GetTitle());
+      TFile input(element->GetTitle());
+      auto* tree = dynamic_cast<TTree*>(input.Get(fTreeName.c_str()));
+      if(tree == nullptr) { continue; }
+      Long64_t entries = (sublist != nullptr ? sublist->GetN() : 0);
+      Long64_t index   = 0;
+      selected += entries;
+      // the entries of the list are sorted, so we can walk through them and the clusters at the same time
+      auto iterator = tree->GetClusterIterator(0);
+      for(Long64_t start = iterator(); start < tree->GetEntries(); start = iterator()) {
+         ++clusters;
+         while(index < entries && sublist->GetEntry(index) < start) { ++index; }
+         if(index < entries && sublist->GetEntry(index) < iterator.GetNextEntry()) { ++used; }
+      }
+   }
+   std::cout << "Entry list '" << fOptions->EntryList() << "' selects " << selected << " entries in " << used << " of " << clusters << " clusters" << std::endl;
+   return selected;
+}
+
+Long64_t BasicFrame::ApplyTimeRange()
+{
+   /// Uses the zone map of each file (building it if needed) to select the entries with an extended timestamp within
+   /// the time range, reading only the clusters at the edges of the range. Returns the number of entries selected.
+   auto*           entryList = new TEntryList("", "");
+   ZoneMap::Counts counts;
+   for(const auto&& obj : *fChain->GetListOfFiles()) {
+      auto*                    element = static_cast<TChainElement*>(obj);
+      std::unique_ptr<ZoneMap> zoneMap(ZoneMap::ForFile(element->GetTitle(), fTreeName, {"extended_timestamp"}));
+      TFile                    input(element->GetTitle());
+      auto*                    tree = dynamic_cast<TTree*>(input.Get(fTreeName.c_str()));
+      TEntryList               fileList("", "", fTreeName.c_str(), element->GetTitle());
+      zoneMap->Select(tree, "extended_timestamp", fOptions->TimeLow(), fOptions->TimeHigh(), fileList, counts);
+      entryList->Add(&fileList);
+   }
+   fChain->SetEntryList(entryList);
+   std::cout << "Time range " << fOptions->TimeLow() << " - " << fOptions->TimeHigh() << " selects " << entryList->GetN() << " entries: "
+             << counts.fSkipped << " clusters skipped, " << counts.fComplete << " completely inside, " << counts.fRead << " read to select entries" << std::endl;
+   return entryList->GetN();
+}
+
+void BasicFrame::ReportClusters()
+{
+   /// The event loop runs one task per cluster, so with fewer clusters than workers some workers stay idle. Only the
+   /// headers of the trees are read to count the clusters.
+   Long64_t clusters = 0;
+   for(const auto&& obj : *fChain->GetListOfFiles()) {
+      auto* element = static_cast<TChainElement*>(obj);
+      TFile input(element->GetTitle());
+      auto* tree = dynamic_cast<TTree*>(input.Get(fTreeName.c_str()));
+      if(tree == nullptr) { continue; }
+      auto iterator = tree->GetClusterIterator(0);
+      for(Long64_t start = iterator(); start < tree->GetEntries(); start = iterator()) { ++clusters; }
+   }
+   if(clusters >= fOptions->MaxWorkers()) { return; }
+   std::cout << DYELLOW << "Only " << clusters << " cluster(s) for " << fOptions->MaxWorkers() << " workers, ";
+   if(fOptions->ParallelUnzip()) {
+      std::cout << "idle workers can only help unzipping the baskets";
+   } else {
+      std::cout << "--parallel-unzip lets idle workers unzip the baskets";
+   }
+   std::cout << RESET_COLOR << std::endl;
+}
+
+void BasicFrame::AddDerivedColumns()
+{
+   /// Adds the derived columns of all files of the chain as friend (writing them first if they aren't cached yet).
+   /// The friend chain has one file per file of the chain, with the same number of entries, so the entries line up.
+   PerfReport::Get()->Start("derived columns");
+   DerivedCache cache(fOptions->DerivedCache(), fOptions->GetCalibration(), fTreeName);
+   fFriend = new TChain(DerivedCache::kTreeName);
+   for(const auto&& obj : *fChain->GetListOfFiles()) {
+      auto* element = static_cast<TChainElement*>(obj);
+      fFriend->Add(cache.Ensure(element->GetTitle(), element->GetEntries()).c_str(), element->GetEntries());
+   }
+   fChain->AddFriend(fFriend);
+   PerfReport::Get()->Stop("derived columns");
+}
+
+void BasicFrame::MapChain()
+{
+   /// Creates a copy of the chain that opens all local files through MappedFile (mmap://), the event loop runs on that
+   /// copy. Entry lists refer to the files by their names, so a chain with an entry list is read without mapping.
+   if(fChain->GetEntryList() != nullptr) {
+      std::cout << DYELLOW << "Not mapping the input files, only some of their entries are processed" << RESET_COLOR << std::endl;
+      return;
+   }
+   fMapped = new TChain(fTreeName.c_str());
+   for(const auto&& obj : *fChain->GetListOfFiles()) {
+      auto*       element = static_cast<TChainElement*>(obj);
+      std::string name    = element->GetTitle();
+      // remote files are read as before
+      if(name.find("://") == std::string::npos) { name = MappedFile::kProtocol + CanonicalPath(name); }
+      fMapped->Add(name.c_str(), element->GetEntries());
+   }
+   if(fFriend != nullptr) {
+      fMapped->AddFriend(fFriend);
+   }
+}
+
+void BasicFrame::ReadLedger()
+{
+   /// Reads the ledger of files and the number of entries processed from them.
+   /// The ledger is only used if the output file it belongs to also still exists.
+   std::ifstream ledger(fLedgerFileName);
+   if(!ledger.is_open()) {
+      return;
+   }
+   if(!FileExists(fOutputFileName.c_str())) {
+      std::cout << "Found ledger '" << fLedgerFileName << "' but no output file '" << fOutputFileName << "', ignoring the ledger" << std::endl;
+      return;
+   }
+   std::string fileName;
+   Long64_t    entries = 0;
+   while(ledger >> fileName >> entries) {
+      fProcessed[fileName] = entries;
+   }
+   std::cout << "Read ledger '" << fLedgerFileName << "' with " << fProcessed.size() << " processed files, merging new data into '" << fOutputFileName << "'" << std::endl;
+   fMerge = !fProcessed.empty();
+}
+
+void BasicFrame::WriteLedger()
+{
+   /// Adds the files of the current pass to the list of processed files and writes the ledger.
+   for(const auto& file : fPending) {
+      fProcessed[file.first] = file.second;
+   }
+   fPending.clear();
+   std::ofstream ledger(fLedgerFileName);
+   for(const auto& file : fProcessed) {
+      ledger << file.first << " " << file.second << std::endl;
+   }
+}
+
 void BasicFrame::Run(Redirect*& redirect)
 {
-   // get output file name
-   std::string outputFileName = Form("%s%s.root", fOutputPrefix.c_str(), fOptions->RunNumberString().c_str());
-   std::cout << "Writing to " << outputFileName << std::endl;
+   // nothing was booked if all data has already been processed (follow mode), so we don't touch the output or ledger
+   if(fDataFrame == nullptr) {
+      return;
+   }
 
-   TFile outputFile(outputFileName.c_str(), "recreate");
+   // get output file name (in follow mode this has been set before and stays the same)
+   if(fOutputFileName.empty()) {
+      fOutputFileName = Form("%s%s.root", fOutputPrefix.c_str(), fOptions->RunNumberString().c_str());
+   }
+   std::cout << (fMerge ? "Merging into " : "Writing to ") << fOutputFileName << std::endl;
+
+   TFile outputFile(fOutputFileName.c_str(), fMerge ? "update" : "recreate");
 
    // stop redirect before we start the progress bar (storing the files we redirect stdout and stderr to first)
    const auto* outFile = redirect->OutFile();
    const auto* errFile = redirect->ErrFile();
 
+   // messages from within the event loop go through the logger into the file stdout was redirected to
+   Logger::Get().Open(outFile, fDataFrame->GetNSlots());
+
    delete redirect;
    // this is needed so the function that created the redirect know it has ended
    // not really needed right now as we create a new redirect further down, but we have it here in case that gets changed
@@ -115,26 +500,22 @@ void BasicFrame::Run(Redirect*& redirect)
    ROOT::RDF::Experimental::AddProgressBar(*fDataFrame);
 #endif
 
+   // for the performance report we count the events processed by each slot and the time it's busy (which adds a little bit of overhead)
+   ROOT::RDF::RResultPtr<SlotTimes::Result_t> slotTimes;
+   if(!fOptions->PerfReportFile().empty()) {
+      slotTimes = fDataFrame->Book<ULong64_t>(SlotTimes(fDataFrame->GetNSlots()), {"rdfentry_"});
+   }
+
    if(fOutput != nullptr) {
       // accessing the result from Book causes the actual processing of the helper
       // so we try and catch any exception
       try {
-         for(auto& list : *fOutput) {
-            // try and switch to the directory this list should be written to
-            if(gDirectory->GetDirectory(list.first.c_str()) && gDirectory->cd(list.first.c_str())) {
-               list.second.Write();
-            } else {
-               // directory this list should be written to doesn't exist, so create it
-               gDirectory->mkdir(list.first.c_str());
-               if(gDirectory->cd(list.first.c_str())) {
-                  list.second.Write();
-               } else {
-                  std::cout << "Error, failed to find or create path " << list.first << ", writing into " << gDirectory->GetPath() << std::endl;
-               }
-            }
-            // switch back to topmost directory
-            while(gDirectory->GetDirectory("..")) { gDirectory->cd(".."); }
-         }
+         PerfReport::Get()->Start("event loop");
+         auto& output = *fOutput;
+         // Finalize already stops the event loop, but if it's a different kind of helper we stop it here
+         PerfReport::Get()->Stop("event loop");
+         PerfReport::Get()->Start("output write");
+         WriteOutput(output, fMerge);
 #if ROOT_VERSION_CODE < ROOT_VERSION(6, 30, 0)
          std::cout << "\r[" << std::left << std::setw(barWidth) << progressBar << ' ' << "100 %]" << std::flush;
 #endif
@@ -146,13 +527,151 @@ void BasicFrame::Run(Redirect*& redirect)
       std::cout << "Error, output list is nullptr!" << std::endl;
    }
 
-   fOptions->GetCalibration()->Write();
+   fOptions->GetCalibration()->Write(nullptr, TObject::kOverwrite);
+
+   // writes all remaining messages and the summary of all messages
+   Logger::Get().Close();
 
    // start new redirect, appending to the previous files we had redirected to
    redirect = new Redirect(outFile, errFile, true);
 
    outputFile.Close();
    std::cout << "Closed '" << outputFile.GetName() << "'" << std::endl;
+   PerfReport::Get()->Stop("output write");
+
+   PerfReport::Get()->AddEvents(fTotalEntries);
+   if(slotTimes) {
+      std::vector<ULong64_t> events;
+      std::vector<double>    busy;
+      for(const auto& slot : *slotTimes) {
+         events.push_back(slot.first);
+         busy.push_back(slot.second);
+      }
+      PerfReport::Get()->AddSlotEvents(events, busy);
+   }
+
+   // only now that the output is safely written do we update the ledger, and any further pass gets merged into this output
+   if(fOptions->Follow()) {
+      WriteLedger();
+      fMerge = true;
+   }
+}
+
+void BasicFrame::WriteOutput(std::map<std::string, TList>& output, bool merge)
+{
+   for(auto& list : output) {
+      // try and switch to the directory this list should be written to
+      if(!(gDirectory->GetDirectory(list.first.c_str()) && gDirectory->cd(list.first.c_str()))) {
+         // directory this list should be written to doesn't exist, so create it
+         gDirectory->mkdir(list.first.c_str());
+         if(!gDirectory->cd(list.first.c_str())) {
+            std::cout << "Error, failed to find or create path " << list.first << ", writing into " << gDirectory->GetPath() << std::endl;
+         }
+      }
+      if(merge) {
+         for(const auto&& obj : list.second) {
+            if(obj->InheritsFrom(TH1::Class())) {
+               // add the histogram already in the file to ours and replace it
+               auto* existing = dynamic_cast<TH1*>(gDirectory->Get(obj->GetName()));
+               if(existing != nullptr) {
+                  static_cast<TH1*>(obj)->Add(existing);
+                  delete existing;
+               }
+               obj->Write(nullptr, TObject::kOverwrite);
+            } else if(obj->InheritsFrom(TiledHistogram::Class())) {
+               // add the tiles already in the file to our histogram and replace them
+               static_cast<TiledHistogram*>(obj)->AddExisting(gDirectory);
+               obj->Write(nullptr, TObject::kOverwrite);
+            } else if(obj->InheritsFrom(SymmetricMatrix::Class())) {
+               auto* existing = dynamic_cast<SymmetricMatrix*>(gDirectory->Get(obj->GetName()));
+               if(existing != nullptr) {
+                  static_cast<SymmetricMatrix*>(obj)->Add(existing);
+                  delete existing;
+               }
+               obj->Write(nullptr, TObject::kOverwrite);
+            } else if(obj->InheritsFrom(SymmetricCube::Class())) {
+               auto* existing = dynamic_cast<SymmetricCube*>(gDirectory->Get(obj->GetName()));
+               if(existing != nullptr) {
+                  static_cast<SymmetricCube*>(obj)->Add(existing);
+                  delete existing;
+               }
+               obj->Write(nullptr, TObject::kOverwrite);
+            } else if(obj->InheritsFrom(TTree::Class())) {
+               // our entries are appended to the tree in the file (which writes its baskets there), so only the new
+               // entries are copied, and the tree in the file is replaced with the longer one
+               auto* existing = dynamic_cast<TTree*>(gDirectory->Get(obj->GetName()));
+               if(existing != nullptr) {
+                  existing->CopyEntries(static_cast<TTree*>(obj));
+                  existing->Write(nullptr, TObject::kOverwrite);
+                  delete existing;
+               } else {
+                  obj->Write();
+               }
+            } else {
+               // anything else we can't merge, so we write a new cycle of it
+               obj->Write();
+            }
+         }
+      } else {
+         list.second.Write();
+      }
+      // tiled histograms own the histograms or cubes that were too large to write, which we don't need anymore
+      std::vector<TObject*> tiled;
+      for(const auto&& obj : list.second) {
+         if(obj->InheritsFrom(TiledHistogram::Class())) { tiled.push_back(obj); }
+      }
+      for(auto* obj : tiled) {
+         list.second.Remove(obj);
+         delete obj;
+      }
+      // switch back to topmost directory
+      while(gDirectory->GetDirectory("..")) { gDirectory->cd(".."); }
+   }
+}
+
+void BasicFrame::Follow(Redirect*& redirect)
+{
+   /// Watches the directories of all input files for new files (using the FileWatcher), and processes all
+   /// new data, merging it into the output file. This continues until the program receives SIGINT (Ctrl-C),
+   /// any pass that has already been started is finished and written before we stop.
+   std::vector<std::string> directories;
+   for(const auto& fileName : fFiles) {
+      auto        slash     = fileName.find_last_of('/');
+      std::string directory = (slash == std::string::npos ? "." : fileName.substr(0, slash));
+      if(std::find(directories.begin(), directories.end(), directory) == directories.end()) {
+         directories.push_back(directory);
+      }
+   }
+
+   FileWatcher watcher(directories, ".bin_tree.root");
+   auto*       oldHandler = std::signal(SIGINT, [](int) { FileWatcher::Stop(); });
+
+   std::cout << "Following " << directories.size() << " director" << (directories.size() == 1 ? "y" : "ies") << " for new files, stop with Ctrl-C" << std::endl;
+
+   while(!FileWatcher::Stopped()) {
+      auto newFiles = watcher.Wait(1000);
+      if(newFiles.empty()) {
+         continue;
+      }
+      for(auto& fileName : newFiles) {
+         // the watcher reports "./file" for files in the current directory
+         if(fileName.compare(0, 2, "./") == 0) {
+            fileName.erase(0, 2);
+         }
+         if(std::find(fFiles.begin(), fFiles.end(), fileName) == fFiles.end()) {
+            std::cout << "Found new file '" << fileName << "'" << std::endl;
+            fFiles.push_back(fileName);
+         }
+      }
+      // re-book with all files, the ledger makes sure we only process data we haven't processed yet
+      Book(fFiles);
+      if(fTotalEntries > 0) {
+         Run(redirect);
+      }
+   }
+
+   std::signal(SIGINT, oldHandler);
+   std::cout << "Stopped following, processed " << fProcessed.size() << " files in total" << std::endl;
 }
 
 void DummyFunctionToLocateBasicFrameLibrary()
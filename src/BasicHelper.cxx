@@ -1,5 +1,19 @@
 #include "BasicHelper.h"
 #include "RVersion.h"
+#include "PerfReport.h"
+#include "TiledHistogram.h"
+#include "NumaTopology.h"
+#include "TFile.h"
+#include "TEntryList.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
 #if ROOT_VERSION_CODE >= ROOT_VERSION(6, 14, 0)
 
 BasicHelper::BasicHelper(TList* input)
@@ -7,78 +21,368 @@ BasicHelper::BasicHelper(TList* input)
 {
 }
 
+namespace {
+template <typename Map>
+void AddToLists(std::map<std::string, TList>& lists, Map& map)
+{
+   for(auto& it : map) {
+      // if the key/name of the object does not contain a forward slash we put it in the root-directory, otherwise we extract the path from the key/name
+      auto lastSlash = it.first.find_last_of('/');
+      lists[lastSlash == std::string::npos ? "" : it.first.substr(0, lastSlash)].Add(it.second);
+   }
+}
+
+template <typename Map, typename Function>
+void CloneMap(const Map& prototype, Map& map, Function clone)
+{
+   for(const auto& it : prototype) {
+      map[it.first] = clone(it.second);
+   }
+}
+
+void AddMonitored(Monitor::Histograms& histograms, const std::string& key, TH1* hist)
+{
+   if(hist->GetBuffer() != nullptr || hist->CanExtendAllAxes()) { return; }
+   histograms[key].push_back(hist);
+}
+
+std::mutex& CloneMutex()
+{
+   static std::mutex mutex;
+   return mutex;
+}
+}   // namespace
+
 void BasicHelper::Setup()
 {
-   const auto nSlots = ROOT::IsImplicitMTEnabled() ? Options::Get()->MaxWorkers() : 1;
+   /// Creates slot 0 (or the prototype for lazy slots), all other slots are created once we know how many slots the
+   /// data frame uses.
+   PerfReport::Get()->Start("Setup");
+   HitEvent::Slots(1);
+   fLists.emplace_back(std::make_shared<std::map<std::string, TList>>());
+   fH1.emplace_back(CustomMap<std::string, TH1*>());
+   fH2.emplace_back(CustomMap<std::string, TH2*>());
+   fH3.emplace_back(CustomMap<std::string, TH3*>());
+   fGG.emplace_back(CustomMap<std::string, SymmetricMatrix*>());
+   fGGG.emplace_back(CustomMap<std::string, SymmetricCube*>());
+   fTree.emplace_back(CustomMap<std::string, TTree*>());
+   fObject.emplace_back(CustomMap<std::string, TObject*>());
+   fCoincidences.emplace_back();
+   fSelections.emplace_back();
+   if(!Options::Get()->HistogramFile().empty()) {
+      fDefinitions.reset(new HistogramDefinitions(Options::Get()->HistogramFile()));
+   }
    TH1::AddDirectory(false);   // turns off warnings about multiple histograms with the same name because ROOT doesn't manage them anymore
-   for(auto i : ROOT::TSeqU(nSlots)) {
+   InitSlot(0);
+   CreateSlot(0);
+   TH1::AddDirectory(true);   // restores old behaviour
+   if(fLazySlots) {
+      // the objects of slot 0 become the prototype, trees stay with slot 0 as they can't be cloned
+      fPrototypeH1.swap(fH1[0]);
+      fPrototypeH2.swap(fH2[0]);
+      fPrototypeH3.swap(fH3[0]);
+      fPrototypeGG.swap(fGG[0]);
+      fPrototypeGGG.swap(fGGG[0]);
+      fPrototypeObject.swap(fObject[0]);
+      AddToLists(fPrototypeLists, fPrototypeH1);
+      AddToLists(fPrototypeLists, fPrototypeH2);
+      AddToLists(fPrototypeLists, fPrototypeH3);
+      AddToLists(fPrototypeLists, fPrototypeGG);
+      AddToLists(fPrototypeLists, fPrototypeGGG);
+      AddToLists(fPrototypeLists, fPrototypeObject);
+      fCreated.assign(1, 0);
+   } else {
+      FillLists(0);
+      fCreated.assign(1, 1);
+   }
+   // create the gates from all cuts (they are read-only, so one for all slots is enough)
+   fGates.clear();
+   for(auto& cut : fCuts) {
+      fGates.emplace(cut.first, Gate(cut.second));
+   }
+   PerfReport::Get()->Stop("Setup");
+}
+
+void BasicHelper::Initialize()
+{
+   if(fBatches && fSelectEntries) {
+      // Select would record the entry the reader is at, i.e. the last one of the batch
+      std::ostringstream str;
+      str << DRED << Prefix() << ": selecting entries isn't possible when processing batches of events!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 22, 0)
+   const unsigned int nSlots = ROOT::IsImplicitMTEnabled() ? ROOT::GetThreadPoolSize() : 1;
+#else
+   const unsigned int nSlots = ROOT::IsImplicitMTEnabled() ? ROOT::GetImplicitMTPoolSize() : 1;
+#endif
+   if(Options::Get()->Numa()) {
+      fPinThreads = NumaTopology::Get().Enable(nSlots);
+   }
+   Slots(nSlots);
+   // the profile only covers this event loop
+   Profiler::Get().Reset(nSlots);
+   // the entry numbers start at 0 again, so events built in a previous event loop must not be reused
+   HitEvent::NewLoop();
+   if(Options::Get()->MonitorInterval() > 0.) {
+      // the helper isn't moved anymore once the event loop starts, so the monitor can keep a pointer to it
+      fMonitor.reset(new Monitor(Options::Get()->MonitorInterval(), fPrefix + Options::Get()->RunNumberString() + ".snapshot.root", [this]() { return MonitoredHistograms(); }));
+   }
+}
+
+Monitor::Histograms BasicHelper::MonitoredHistograms()
+{
+   /// Only slots that have been created are used, their maps don't change anymore during the event loop. Histograms
+   /// that can reallocate their arrays while they are filled (with a buffer or extendable axes) are left out, as are
+   /// the symmetric matrices and cubes.
+   std::vector<unsigned int> slots;
+   {
+      std::lock_guard<std::mutex> lock(CloneMutex());
+      for(unsigned int slot = 0; slot < fCreated.size(); ++slot) {
+         if(fCreated[slot] != 0) { slots.push_back(slot); }
+      }
+   }
+   Monitor::Histograms histograms;
+   for(auto slot : slots) {
+      for(auto& it : fH1[slot]) { AddMonitored(histograms, it.first, it.second); }
+      for(auto& it : fH2[slot]) { AddMonitored(histograms, it.first, it.second); }
+      for(auto& it : fH3[slot]) { AddMonitored(histograms, it.first, it.second); }
+   }
+   return histograms;
+}
+
+void BasicHelper::InitTask(TTreeReader* reader, unsigned int slot)
+{
+   if(fPinThreads) { NumaTopology::Get().Pin(slot); }
+   bool created = false;
+   {
+      // CloneSlot sets this under the same lock
+      std::lock_guard<std::mutex> lock(CloneMutex());
+      created = fCreated[slot] != 0;
+   }
+   if(!created) { CloneSlot(slot); }
+   // each task has its own chain, so the file of the current entry has to be looked up again
+   fSelections[slot].fReader  = reader;
+   fSelections[slot].fEntries = nullptr;
+}
+
+void BasicHelper::Select(unsigned int slot)
+{
+   /// The entry is stored as entry number within its file, so the entry list doesn't depend on the other files of the
+   /// chain. Only the first entry of each file of a task needs to look up the file name.
+   auto& selection = fSelections[slot];
+   auto* chain     = selection.fReader->GetTree();
+   if(selection.fEntries == nullptr || chain->GetTreeNumber() != selection.fTreeNumber) {
+      auto* tree            = chain->GetTree();
+      selection.fTreeNumber = chain->GetTreeNumber();
+      selection.fTreeName   = tree->GetName();
+      selection.fEntries    = &selection.fFiles[tree->GetCurrentFile()->GetName()];
+   }
+   selection.fEntries->push_back(chain->GetTree()->GetReadEntry());
+}
+
+void BasicHelper::Slots(unsigned int nSlots)
+{
+   /// Sizes all per-slot members for this number of slots (this has to happen before the event loop starts, as the
+   /// vectors can't grow while the slots are running), calls InitSlot for all new slots, and, unless we use lazy
+   /// slots, creates their objects by calling CreateHistograms.
+   // this is called from Initialize, so we don't add it to the time of Setup
+   PerfReport::Get()->Start("slot creation");
+   HitEvent::Slots(nSlots);
+   fAddDirectory = TH1::AddDirectoryStatus();
+   TH1::AddDirectory(false);
+   const auto first = static_cast<unsigned int>(fLists.size());
+   for(auto slot = first; slot < nSlots; ++slot) {
       fLists.emplace_back(std::make_shared<std::map<std::string, TList>>());
       fH1.emplace_back(CustomMap<std::string, TH1*>());
       fH2.emplace_back(CustomMap<std::string, TH2*>());
       fH3.emplace_back(CustomMap<std::string, TH3*>());
+      fGG.emplace_back(CustomMap<std::string, SymmetricMatrix*>());
+      fGGG.emplace_back(CustomMap<std::string, SymmetricCube*>());
       fTree.emplace_back(CustomMap<std::string, TTree*>());
       fObject.emplace_back(CustomMap<std::string, TObject*>());
-      CreateHistograms(i);
-      for(auto& it : fH1[i]) {
-         // if the key/name of the histogram does not contain a forward slash we put it in the root-directory
-         if(it.first.find_last_of('/') == std::string::npos) {
-            (*fLists[i])[""].Add(it.second);
-         } else {
-            // extract the path from the key/name
-            auto lastSlash = it.first.find_last_of('/');
-            (*fLists[i])[it.first.substr(0, lastSlash)].Add(it.second);
-         }
-      }
-      for(auto& it : fH2[i]) {
-         // if the key/name of the histogram does not contain a forward slash we put it in the root-directory
-         if(it.first.find_last_of('/') == std::string::npos) {
-            (*fLists[i])[""].Add(it.second);
-         } else {
-            // extract the path from the key/name
-            auto lastSlash = it.first.find_last_of('/');
-            (*fLists[i])[it.first.substr(0, lastSlash)].Add(it.second);
-         }
+      fCoincidences.emplace_back();
+      fSelections.emplace_back();
+      InitSlot(slot);
+      if(fLazySlots) {
+         fCreated.push_back(0);
+      } else if(fPinThreads) {
+         // created below, once all per-slot members have their final size
+         fCreated.push_back(1);
+      } else {
+         CreateSlot(slot);
+         FillLists(slot);
+         fCreated.push_back(1);
       }
-      for(auto& it : fH3[i]) {
-         // if the key/name of the histogram does not contain a forward slash we put it in the root-directory
-         if(it.first.find_last_of('/') == std::string::npos) {
-            (*fLists[i])[""].Add(it.second);
-         } else {
-            // extract the path from the key/name
-            auto lastSlash = it.first.find_last_of('/');
-            (*fLists[i])[it.first.substr(0, lastSlash)].Add(it.second);
-         }
-      }
-      for(auto& it : fTree[i]) {
-         // trees can only be written into the root-directory due to the way they get merge in Finalize (for now?)
-         (*fLists[i])[""].Add(it.second);
-      }
-      for(auto& it : fObject[i]) {
-         // if the key/name of the histogram does not contain a forward slash we put it in the root-directory
-         if(it.first.find_last_of('/') == std::string::npos) {
-            (*fLists[i])[""].Add(it.second);
-         } else {
-            // extract the path from the key/name
-            auto lastSlash = it.first.find_last_of('/');
-            (*fLists[i])[it.first.substr(0, lastSlash)].Add(it.second);
+   }
+   if(!fLazySlots && fPinThreads) { CreateOnNodes(first, nSlots); }
+   // with lazy slots the histograms are cloned during the event loop, so they must not be added to a directory,
+   // otherwise we restore the old behaviour
+   TH1::AddDirectory(fLazySlots ? false : fAddDirectory);
+   PerfReport::Get()->Stop("slot creation");
+}
+
+void BasicHelper::DeletePrototype()
+{
+   /// All objects of the prototype are in its output lists, so deleting those deletes all of them.
+   for(auto& list : fPrototypeLists) {
+      list.second.Delete();
+   }
+   fPrototypeLists.clear();
+   fPrototypeH1.clear();
+   fPrototypeH2.clear();
+   fPrototypeH3.clear();
+   fPrototypeGG.clear();
+   fPrototypeGGG.clear();
+   fPrototypeObject.clear();
+}
+
+void BasicHelper::CreateSlot(unsigned int slot)
+{
+   CreateHistograms(slot);
+   if(fDefinitions != nullptr) {
+      fDefinitions->Create(fH1[slot], fH2[slot], fH3[slot]);
+   }
+}
+
+template <typename Map>
+size_t BasicHelper::Resolve(const Map& map, const std::string& key) const
+{
+   auto it = map.find(key);
+   if(it == map.end()) {
+      std::ostringstream str;
+      str << DRED << Prefix() << ": can't create a handle for \"" << key << "\", there is no histogram with this key (handles can only be created after Setup)!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   return static_cast<size_t>(std::distance(map.begin(), it));
+}
+
+HistogramHandle<TH1> BasicHelper::H1Handle(const std::string& key) const
+{
+   return {Resolve(fLazySlots ? fPrototypeH1 : fH1.at(0), key), key};
+}
+
+HistogramHandle<TH2> BasicHelper::H2Handle(const std::string& key) const
+{
+   return {Resolve(fLazySlots ? fPrototypeH2 : fH2.at(0), key), key};
+}
+
+HistogramHandle<TH3> BasicHelper::H3Handle(const std::string& key) const
+{
+   return {Resolve(fLazySlots ? fPrototypeH3 : fH3.at(0), key), key};
+}
+
+void BasicHelper::FillLists(unsigned int slot)
+{
+   AddToLists(*fLists[slot], fH1[slot]);
+   AddToLists(*fLists[slot], fH2[slot]);
+   AddToLists(*fLists[slot], fH3[slot]);
+   AddToLists(*fLists[slot], fGG[slot]);
+   AddToLists(*fLists[slot], fGGG[slot]);
+   for(auto& it : fTree[slot]) {
+      // trees can only be written into the root-directory due to the way they get merge in Finalize (for now?)
+      (*fLists[slot])[""].Add(it.second);
+   }
+   AddToLists(*fLists[slot], fObject[slot]);
+}
+
+void BasicHelper::CreateOnNodes(unsigned int first, unsigned int last)
+{
+   /// Memory is placed on the node of the thread that first touches it, so the objects of each slot are created by a
+   /// thread that is pinned to the core of the slot. All slots are created at the same time, so CreateHistograms is
+   /// called for different slots in parallel, like CloneSlot is for lazy slots.
+   std::vector<std::exception_ptr> errors(last - first);
+   std::vector<std::thread>        threads;
+   for(auto slot = first; slot < last; ++slot) {
+      threads.emplace_back([this, slot, &error = errors[slot - first]]() {
+         try {
+            NumaTopology::Get().Pin(slot);
+            CreateSlot(slot);
+            FillLists(slot);
+         } catch(...) {
+            error = std::current_exception();
          }
-      }
-      CheckSizes(i, "use");
+      });
+   }
+   for(auto& thread : threads) {
+      thread.join();
+   }
+   for(auto& error : errors) {
+      if(error) { std::rethrow_exception(error); }
+   }
+}
+
+void BasicHelper::CloneSlot(unsigned int slot)
+{
+   /// Histograms, symmetric matrices, and cubes are cloned in parallel (they aren't added to any directory), other
+   /// objects might use global state when they are cloned, so they are cloned one slot at a time.
+   CloneMap(fPrototypeH1, fH1[slot], [](TH1* hist) { return static_cast<TH1*>(hist->Clone()); });
+   CloneMap(fPrototypeH2, fH2[slot], [](TH2* hist) { return static_cast<TH2*>(hist->Clone()); });
+   CloneMap(fPrototypeH3, fH3[slot], [](TH3* hist) { return static_cast<TH3*>(hist->Clone()); });
+   CloneMap(fPrototypeGG, fGG[slot], [](SymmetricMatrix* matrix) { return new SymmetricMatrix(*matrix); });
+   CloneMap(fPrototypeGGG, fGGG[slot], [](SymmetricCube* cube) { return new SymmetricCube(*cube); });
+   {
+      std::lock_guard<std::mutex> lock(CloneMutex());
+      CloneMap(fPrototypeObject, fObject[slot], [](TObject* obj) { return obj->Clone(); });
+   }
+   FillLists(slot);
+   {
+      // the monitor checks which slots have been created under the same lock
+      std::lock_guard<std::mutex> lock(CloneMutex());
+      fCreated[slot] = 1;
    }
-   TH1::AddDirectory(true);   // restores old behaviour
 }
 
 void BasicHelper::Finalize()
 {
    /// This function merges all maps of lists into the map of the first slot (slot 0)
-   CheckSizes(0, "write");
+   // Finalize gets called once the event loop is done
+   PerfReport::Get()->Stop("event loop");
+   PerfReport::Get()->Start("Finalize");
+   // the monitor has to be stopped before the slots are merged
+   fMonitor.reset();
+   TH1::AddDirectory(fAddDirectory);
+   // with lazy slots some slots might not have been used, we merge into the first one that was (or create slot 0 if
+   // none was, so we still write empty histograms), and make sure that's slot 0
+   auto first = std::find(fCreated.begin(), fCreated.end(), 1);
+   if(first == fCreated.end()) {
+      CloneSlot(0);
+   } else if(first != fCreated.begin()) {
+      auto slot = static_cast<size_t>(first - fCreated.begin());
+      fLists[0]->swap(*fLists[slot]);
+      fH1[0].swap(fH1[slot]);
+      fH2[0].swap(fH2[slot]);
+      fH3[0].swap(fH3[slot]);
+      fGG[0].swap(fGG[slot]);
+      fGGG[0].swap(fGGG[slot]);
+      fTree[0].swap(fTree[slot]);
+      fObject[0].swap(fObject[slot]);
+      std::swap(fCreated[0], fCreated[slot]);
+   }
+   DeletePrototype();
+   if(Profiler::Get().Active()) {
+      // the number of fills per slot has to be collected before the histograms are merged
+      std::map<std::string, std::vector<double>> fills;
+      for(auto slot : ROOT::TSeqU(fLists.size())) {
+         for(const auto& list : *fLists[slot]) {
+            for(const auto&& obj : list.second) {
+               if(obj->InheritsFrom(TH1::Class())) {
+                  auto& fill = fills[list.first.empty() ? obj->GetName() : list.first + "/" + obj->GetName()];
+                  fill.resize(fLists.size(), 0.);
+                  fill[slot] = static_cast<TH1*>(obj)->GetEntries();
+               }
+            }
+         }
+      }
+      Profiler::Get().Report(fPrefix, fills);
+   }
    // get all objects from the first slot
    auto& res = fLists[0];
    // map to keep track of trees we found
    std::map<TTree*, TList*> treeList;
    // loop over all other slots
    for(auto slot : ROOT::TSeqU(1, fLists.size())) {
-      CheckSizes(slot, "write");
+      if(fCreated[slot] == 0) { continue; }
       // loop over each TList in the map we merge into
       for(const auto& list : *res) {
          // loop over each object in the list
@@ -89,20 +393,23 @@ void BasicHelper::Finalize()
                if(obj->InheritsFrom(TH1::Class())) {
                   // histograms can just be added together
                   static_cast<TH1*>(obj)->Add(static_cast<TH1*>((*fLists[slot]).at(list.first).FindObject(obj->GetName())));
+               } else if(obj->InheritsFrom(SymmetricMatrix::Class())) {
+                  static_cast<SymmetricMatrix*>(obj)->Add(static_cast<SymmetricMatrix*>((*fLists[slot]).at(list.first).FindObject(obj->GetName())));
+               } else if(obj->InheritsFrom(SymmetricCube::Class())) {
+                  static_cast<SymmetricCube*>(obj)->Add(static_cast<SymmetricCube*>((*fLists[slot]).at(list.first).FindObject(obj->GetName())));
                } else if(obj->InheritsFrom(TTree::Class())) {
                   // trees are added to the list and merged later
                   auto* tree = static_cast<TTree*>(obj);
                   // std::cout<<slot<<" copied "<<tree->CopyEntries(static_cast<TTree*>((*fLists[slot]).at(list.first).FindObject(obj->GetName())))<<" bytes to tree "<<tree->GetName()<<std::endl;
                   treeList.emplace(tree, new TList);   // emplace does not overwrite existing elements!
                   treeList.at(tree)->Add((*fLists[slot]).at(list.first).FindObject(obj->GetName()));
-                  std::cout << slot << ": adding " << treeList.at(tree)->GetSize() << ". " << tree->GetName() << " tree with " << static_cast<TTree*>((*fLists[slot]).at(list.first).FindObject(obj->GetName()))->GetEntries() << " entries" << std::endl;
                } else {
-                  std::cerr << "Object '" << obj->GetName() << "' is not a histogram (" << obj->ClassName() << "), don't know what to do with it!" << std::endl;
+                  HIGS_LOG(slot, "Object '" << obj->GetName() << "' is not a histogram (" << obj->ClassName() << "), don't know what to do with it!");
                }
             } else {
-               // only warn about not finding the object in other lists for histograms and trees
-               if(obj->InheritsFrom(TH1::Class()) || obj->InheritsFrom(TTree::Class())) {
-                  std::cerr << "Failed to find object '" << obj->GetName() << "' in " << slot << ". list" << std::endl;
+               // only warn about not finding the object in other lists for histograms and trees (rate-limited, as this is done for every object of every slot)
+               if(obj->InheritsFrom(TH1::Class()) || obj->InheritsFrom(TTree::Class()) || obj->InheritsFrom(SymmetricMatrix::Class()) || obj->InheritsFrom(SymmetricCube::Class())) {
+                  HIGS_LOG(slot, "Failed to find object '" << obj->GetName() << "' in " << slot << ". list");
                }
             }
          }
@@ -112,41 +419,141 @@ void BasicHelper::Finalize()
    for(auto& tree : treeList) {
       tree.second->Add(tree.first);
       Long64_t entries = 0;
-      int      i       = 0;
       for(const auto&& obj : *tree.second) {
-         std::cout << ++i << ". " << tree.first->GetName() << " tree: " << static_cast<TTree*>(obj)->GetEntries() << " entries" << std::endl;
          entries += static_cast<TTree*>(obj)->GetEntries();
       }
-      std::cout << "total of " << entries << " entries" << std::endl;
       auto* newTree = TTree::MergeTrees(tree.second);
-      std::cout << "Got new tree with " << newTree->GetEntries() << " => " << entries - newTree->GetEntries() << " less than total" << std::endl;
+      // one summary line per tree instead of one line per slot
+      std::cout << "Merged " << tree.second->GetSize() << " " << tree.first->GetName() << " trees with a total of " << entries << " entries into a tree with " << newTree->GetEntries() << " entries" << std::endl;
       (*res).at("").Remove(tree.first);
       (*res).at("").Add(newTree);
       //	std::cout<<"Adding "<<tree.second->GetSize()<<" "<<tree.first->GetName()<<" trees to "<<tree.first->GetEntries()<<" entries"<<std::endl;
       //	tree.first->Merge(tree.second);
       //	std::cout<<"Got "<<tree.first->GetEntries()<<" entries"<<std::endl;
    }
+   // the user can still use the merged symmetric matrices and cubes (e.g. for gated projections) in EndOfSort
    EndOfSort(res);
+   ExpandSymmetric(*res);
+   // only the merged objects are checked, so large histograms are still merged from all slots
+   CheckSizes(0, "write");
+   if(fSelectEntries) { WriteSelection(); }
+   PerfReport::Get()->Stop("Finalize");
+}
+
+void BasicHelper::WriteSelection()
+{
+   /// The slots process the clusters of a file in any order, so the entries of each file are sorted before they are
+   /// added to the entry list. In follow mode the entries selected in earlier passes are kept.
+   std::string                                  treeName;
+   std::map<std::string, std::vector<Long64_t>> files;
+   for(auto& selection : fSelections) {
+      if(treeName.empty()) { treeName = selection.fTreeName; }
+      for(auto& file : selection.fFiles) {
+         auto& entries = files[file.first];
+         entries.insert(entries.end(), file.second.begin(), file.second.end());
+      }
+      selection.fFiles.clear();
+   }
+
+   TDirectory::TContext context;   // restores the current directory when we're done
+   std::string          fileName = fPrefix + Options::Get()->RunNumberString() + ".entries.root";
+   TFile                file(fileName.c_str(), Options::Get()->Follow() ? "update" : "recreate");
+   // the entry lists belong to the file, which deletes them when it's closed
+   auto* existing = dynamic_cast<TEntryList*>(file.Get(kEntryListName));
+   auto* list     = new TEntryList(kEntryListName, Form("entries selected by %s", fPrefix.c_str()));
+   if(existing != nullptr) {
+      list->Add(existing);
+   }
+   for(auto& entries : files) {
+      std::sort(entries.second.begin(), entries.second.end());
+      TEntryList fileList("", "", treeName.c_str(), entries.first.c_str());
+      for(auto entry : entries.second) {
+         fileList.Enter(entry);
+      }
+      list->Add(&fileList);
+   }
+   list->Write(nullptr, TObject::kOverwrite);
+   std::cout << "Wrote " << list->GetN() << " selected entries of " << files.size() << " file(s) to '" << fileName << "'" << std::endl;
+}
+
+void BasicHelper::ExpandSymmetric(std::map<std::string, TList>& lists)
+{
+   /// The expanded matrices and cubes replace the compressed ones, which are deleted (this happens after EndOfSort,
+   /// so the maps of slot 0 aren't used anymore).
+   for(auto& list : lists) {
+      std::vector<TObject*> compressed;
+      for(const auto&& obj : list.second) {
+         if(obj->InheritsFrom(SymmetricMatrix::Class()) || obj->InheritsFrom(SymmetricCube::Class())) {
+            compressed.push_back(obj);
+         }
+      }
+      for(auto* obj : compressed) {
+         if(obj->InheritsFrom(SymmetricMatrix::Class())) {
+            list.second.Remove(obj);
+            list.second.Add(static_cast<SymmetricMatrix*>(obj)->Expand());
+            delete obj;
+            continue;
+         }
+         auto* cube = static_cast<SymmetricCube*>(obj);
+         if(cube->ExpandedBytes() > static_cast<size_t>(fSizeLimit)) {
+            // the full cube couldn't be written as one object, so we keep the compressed one (if that's too large as
+            // well, CheckSizes writes the full cube in tiles)
+            if(cube->Bytes() <= static_cast<size_t>(fSizeLimit)) {
+               std::cout << "Keeping symmetric cube '" << cube->GetName() << "' compressed, expanded it would need " << cube->ExpandedBytes() / 1024. / 1024. / 1024. << " GB" << std::endl;
+            }
+            continue;
+         }
+         list.second.Remove(obj);
+         list.second.Add(cube->Expand());
+         delete cube;
+      }
+   }
 }
 
 void BasicHelper::CheckSizes(unsigned int slot, const char* usage)
 {
-   /// check size of each object in the output list
+   /// check size of each object in the output list, histograms and symmetric cubes that are too large are replaced by
+   /// tiled histograms (which own them from then on), all other objects that are too large are removed
    // loop over each TList in the map
    for(auto& list : *fLists[slot]) {
+      std::vector<std::pair<TObject*, Long64_t>> tooLarge;
       // loop over each object in the list
       for(const auto&& obj : list.second) {
-         TBufferFile buf(TBuffer::kWrite, 10000);
-         obj->IsA()->WriteBuffer(buf, obj);
-         if(buf.Length() > fSizeLimit) {
-            std::ostringstream str;
-            str << DRED << slot << ". slot: " << obj->ClassName() << " '" << obj->GetName() << "' too large to " << usage << ": " << buf.Length() << " bytes = " << buf.Length() / 1024. / 1024. / 1024. << " GB, removing it!" << RESET_COLOR << std::endl;
-            std::cout << str.str();
-            // we only remove it from the output list, not deleting the object itself
-            // this way the filling of that histogram will still work, it just won't get written to file
-            // we remove it from all lists though, not just the first one
-            list.second.Remove(obj);
+         // the size of symmetric matrices, cubes, and large histograms is known, there is no need to stream them (which could take a while or fail)
+         Long64_t length = 0;
+         if(obj->InheritsFrom(SymmetricMatrix::Class())) {
+            length = static_cast<Long64_t>(static_cast<SymmetricMatrix*>(obj)->Bytes());
+         } else if(obj->InheritsFrom(SymmetricCube::Class())) {
+            length = static_cast<Long64_t>(static_cast<SymmetricCube*>(obj)->Bytes());
+         } else if(obj->InheritsFrom(TH1::Class()) && TiledHistogram::Size(static_cast<TH1*>(obj)) > fSizeLimit) {
+            length = TiledHistogram::Size(static_cast<TH1*>(obj));
+         } else {
+            TBufferFile buf(TBuffer::kWrite, 10000);
+            obj->IsA()->WriteBuffer(buf, obj);
+            length = buf.Length();
+         }
+         // record the size of the objects written for the performance report (the size is the same for all slots)
+         if(slot == 0 && strcmp(usage, "write") == 0) {
+            PerfReport::Get()->ObjectSize(list.first.empty() ? obj->GetName() : list.first + "/" + obj->GetName(), length, fLists.size());
+         }
+         if(length > fSizeLimit) {
+            tooLarge.emplace_back(obj, length);
+         }
+      }
+      for(auto& [obj, length] : tooLarge) {
+         std::ostringstream str;
+         // we only remove it from the output list, not deleting the object itself, this way the filling of that histogram will still work
+         // (a tiled histogram deletes it once it has been written and is deleted itself)
+         list.second.Remove(obj);
+         if(obj->InheritsFrom(TH1::Class()) || obj->InheritsFrom(SymmetricCube::Class())) {
+            // the tiles of a cube are slabs of the full cube, created from the compressed cube one at a time
+            auto* tiled = (obj->InheritsFrom(TH1::Class()) ? new TiledHistogram(static_cast<TH1*>(obj)) : new TiledHistogram(static_cast<SymmetricCube*>(obj)));
+            list.second.Add(tiled);
+            str << DYELLOW << slot << ". slot: " << obj->ClassName() << " '" << obj->GetName() << "' too large to " << usage << " as one object (" << length / 1024. / 1024. / 1024. << " GB), using " << tiled->Tiles() << " tiles instead!" << RESET_COLOR << std::endl;
+         } else {
+            str << DRED << slot << ". slot: " << obj->ClassName() << " '" << obj->GetName() << "' too large to " << usage << ": " << length << " bytes = " << length / 1024. / 1024. / 1024. << " GB, removing it!" << RESET_COLOR << std::endl;
          }
+         std::cout << str.str();
       }
    }
 }
@@ -36,6 +36,28 @@ Calibration::Calibration(const char* file)
    }
 }
 
+ULong64_t Calibration::Hash() const
+{
+   /// FNV-1a hash of the bytes of all values.
+   ULong64_t hash = 14695981039346656037ULL;
+   auto      add  = [&hash](double value) {
+      const auto* bytes = reinterpret_cast<const unsigned char*>(&value);   // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      for(size_t i = 0; i < sizeof(value); ++i) {
+         hash ^= bytes[i];               // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+         hash *= 1099511628211ULL;
+      }
+   };
+   for(size_t i = 0; i < fOffset.size(); ++i) {
+      add(fOffset[i]);
+      add(fGain[i]);
+   }
+   add(fTimeOffset);
+   add(fTimeGain);
+   add(fTimestampOffset);
+   add(fTimestampGain);
+   return hash;
+}
+
 void Calibration::Print(Option_t*) const
 {
    std::cout << "Got " << fGain.size() << " energy calibrations" << std::endl;
@@ -0,0 +1,81 @@
+#include "Coincidences.h"
+
+#include <algorithm>
+#include <numeric>
+
+void Coincidences::Add(uint8_t detector, const ROOT::RVecD& amplitude, const ROOT::RVecD& time, const Calibration* calibration, int firstId)
+{
+   for(size_t i = 0; i < amplitude.size() && i < time.size(); ++i) {
+      if(std::isnan(amplitude[i])) { continue; }
+      Add(detector, static_cast<uint16_t>(i), calibration->Energy(amplitude[i], firstId + static_cast<int>(i)), calibration->Time(time[i]));
+   }
+}
+
+void Coincidences::Sort()
+{
+   if(fSorted) { return; }
+   // sort the indices by time and then re-order all arrays
+   fOrder.resize(fTime.size());
+   std::iota(fOrder.begin(), fOrder.end(), 0);
+   std::sort(fOrder.begin(), fOrder.end(), [this](uint32_t lhs, uint32_t rhs) { return fTime[lhs] < fTime[rhs]; });
+   fDetectorBuffer.resize(fTime.size());
+   fIndexBuffer.resize(fTime.size());
+   fEnergyBuffer.resize(fTime.size());
+   fTimeBuffer.resize(fTime.size());
+   for(size_t hit = 0; hit < fOrder.size(); ++hit) {
+      fDetectorBuffer[hit] = fDetector[fOrder[hit]];
+      fIndexBuffer[hit]    = fIndex[fOrder[hit]];
+      fEnergyBuffer[hit]   = fEnergy[fOrder[hit]];
+      fTimeBuffer[hit]     = fTime[fOrder[hit]];
+   }
+   fDetector.swap(fDetectorBuffer);
+   fIndex.swap(fIndexBuffer);
+   fEnergy.swap(fEnergyBuffer);
+   fTime.swap(fTimeBuffer);
+   fSorted = true;
+}
+
+void Coincidences::FillMatrices(TH2* prompt, TH2* random, uint64_t detectorMask) const
+{
+   ForEachPair([this, prompt, random, detectorMask](size_t first, size_t second, EWindow window) {
+      if(!InMask(first, detectorMask) || !InMask(second, detectorMask)) { return; }
+      TH2* hist = (window == EWindow::kPrompt ? prompt : random);
+      if(hist == nullptr) { return; }
+      hist->Fill(fEnergy[first], fEnergy[second]);
+      hist->Fill(fEnergy[second], fEnergy[first]);
+   });
+}
+
+void Coincidences::FillMatrices(SymmetricMatrix* prompt, SymmetricMatrix* random, uint64_t detectorMask) const
+{
+   ForEachPair([this, prompt, random, detectorMask](size_t first, size_t second, EWindow window) {
+      if(!InMask(first, detectorMask) || !InMask(second, detectorMask)) { return; }
+      SymmetricMatrix* matrix = (window == EWindow::kPrompt ? prompt : random);
+      if(matrix == nullptr) { return; }
+      matrix->Fill(fEnergy[first], fEnergy[second]);
+   });
+}
+
+void Coincidences::FillCubes(SymmetricCube* prompt, SymmetricCube* random, uint64_t detectorMask) const
+{
+   ForEachTriple([this, prompt, random, detectorMask](size_t first, size_t second, size_t third, EWindow window) {
+      if(!InMask(first, detectorMask) || !InMask(second, detectorMask) || !InMask(third, detectorMask)) { return; }
+      SymmetricCube* cube = (window == EWindow::kPrompt ? prompt : random);
+      if(cube == nullptr) { return; }
+      cube->Fill(fEnergy[first], fEnergy[second], fEnergy[third]);
+   });
+}
+
+void Coincidences::FillTimeDifference(TH1* hist, uint64_t detectorMask) const
+{
+   // this uses all pairs within reach, not just those within the windows, so the spectrum has no gaps
+   const size_t size = fTime.size();
+   for(size_t first = 0; first < size; ++first) {
+      if(!InMask(first, detectorMask)) { continue; }
+      for(size_t second = first + 1; second < size && fTime[second] - fTime[first] <= fReach; ++second) {
+         if(!InMask(second, detectorMask)) { continue; }
+         bool ordered = (fDetector[first] < fDetector[second] || (fDetector[first] == fDetector[second] && fIndex[first] < fIndex[second]));
+         hist->Fill(ordered ? fTime[second] - fTime[first] : fTime[first] - fTime[second]);
+      }
+   }
+}
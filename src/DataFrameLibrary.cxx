@@ -11,6 +11,7 @@
 
 #include "Options.h"
 #include "BasicFrame.h"
+#include "PerfReport.h"
 
 bool FileExists(const char* filename)
 {
@@ -25,6 +26,14 @@ bool FileExists(const char* filename)
    return !S_ISDIR(buffer.st_mode);
 }
 
+namespace {
+std::string LibraryExtension(const char* extension)
+{
+   /// Helpers compiled with profiling get their own library and object file, so switching between profiling and normal runs doesn't use the wrong library.
+   return Options::Get()->Profile() ? std::string(".profiling") + extension : std::string(extension);
+}
+}   // namespace
+
 // redeclare dlsym to be a function returning a function pointer instead of void *
 extern "C" void* (*dlsym(void* handle, const char* symbol))();
 
@@ -42,6 +51,8 @@ void DataFrameLibrary::Load()
       return;
    }
 
+   PerfReport::Get()->Start("helper compile/load");
+
    std::string libraryPath = Options::Get()->Helper();
    if(libraryPath.empty()) {
       std::ostringstream str;
@@ -56,8 +67,8 @@ void DataFrameLibrary::Load()
    if(dot != std::string::npos && (dot > slash || slash == std::string::npos) && libraryPath.substr(dot) == ".cxx") {
       // let's get the full path first (or maybe move this into the function?)
       Compile(libraryPath, dot, slash);
-      // replace the .cxx extension with .so
-      libraryPath.replace(dot, std::string::npos, ".so");
+      // replace the .cxx extension with .so (or .profiling.so)
+      libraryPath.replace(dot, std::string::npos, LibraryExtension(".so"));
    }
 
    if(!FileExists(libraryPath.c_str())) {
@@ -86,6 +97,8 @@ void DataFrameLibrary::Load()
       throw std::runtime_error(str.str());
    }
    std::cout << "\tUsing library " << libraryPath << std::endl;
+
+   PerfReport::Get()->Stop("helper compile/load");
 }
 
 void DataFrameLibrary::Compile(std::string& path, const size_t& dot, const size_t& slash)
@@ -95,7 +108,8 @@ void DataFrameLibrary::Compile(std::string& path, const size_t& dot, const size_
    /// path, position of the last dot, and the position of the last slash.
    /// \details
    /// Other flags used are "-c -fPIC -g", `root-config --cflags --glibs`, and the directory
-   /// the path points to as include directory.
+   /// the path points to as include directory. If profiling is enabled, HIGS_PROFILING is
+   /// defined as well, which turns on the HIGS_PROFILE and HIGS_COUNT macros.
    /// \param[in] path path of the .cxx file
    /// \param[in] dot position of the last dot (guaranteed to be after the last slash!)
    /// \param[in] slash position of the last slash (can be std::string::npos)
@@ -104,7 +118,7 @@ void DataFrameLibrary::Compile(std::string& path, const size_t& dot, const size_
    // we know dot != npos and either dot > slash or slash = npos
    std::string sourceFile    = path;
    std::string headerFile    = path.replace(dot, std::string::npos, ".hh");
-   std::string sharedLibrary = path.replace(dot, std::string::npos, ".so");
+   std::string sharedLibrary = path.replace(dot, std::string::npos, LibraryExtension(".so"));
    // first we get the stats of the file's involved (.cxx, .hh, .so)
    struct stat sourceStat {};
    if(stat(sourceFile.c_str(), &sourceStat) != 0) {
@@ -145,9 +159,12 @@ void DataFrameLibrary::Compile(std::string& path, const size_t& dot, const size_
       includePath = path.substr(0, slash);
    }
    std::cout << DCYAN << "----------  starting compilation of user code  ----------" << RESET_COLOR << std::endl;
-   std::string        objectFile = path.replace(dot, std::string::npos, ".o");
+   std::string        objectFile = path.replace(dot, std::string::npos, LibraryExtension(".o"));
    std::ostringstream command;
    command << "g++ -c -fPIC -g $(root-config --cflags) -I$HIGSSYS/include -I" << includePath;
+   if(Options::Get()->Profile()) {
+      command << " -DHIGS_PROFILING";
+   }
 #ifdef OS_DARWIN
    command << " -I/opt/local/include ";
 #endif
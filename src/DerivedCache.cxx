@@ -0,0 +1,194 @@
+#include "DerivedCache.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreeReader.h"
+#include "TTreeReaderArray.h"
+#include "TSystem.h"
+#include "TRandom3.h"
+
+#include "Globals.h"
+#include "Addback.h"
+
+namespace {
+/// Calibrates all channels of one detector type, NaN amplitudes stay NaN (channel i has the id firstId + i).
+void Calibrate(TTreeReaderArray<double>& amplitude, TTreeReaderArray<double>& time, int firstId, const Calibration* calibration, std::vector<double>& energies, std::vector<double>& times)
+{
+   energies.resize(amplitude.GetSize());
+   times.resize(amplitude.GetSize());
+   for(size_t i = 0; i < amplitude.GetSize(); ++i) {
+      energies[i] = std::isnan(amplitude[i]) ? NAN : calibration->Energy(amplitude[i], firstId + static_cast<int>(i));
+      times[i]    = (i < time.GetSize() ? calibration->Time(time[i]) : NAN);
+   }
+}
+
+/// Replaces gRandom (which the calibration uses for dithering) while it exists.
+class RandomOverride {
+public:
+   explicit RandomOverride(UInt_t seed)
+      : fRandom(seed), fPrevious(gRandom)
+   {
+      gRandom = &fRandom;
+   }
+   RandomOverride(const RandomOverride&)            = delete;
+   RandomOverride(RandomOverride&&)                 = delete;
+   RandomOverride& operator=(const RandomOverride&) = delete;
+   RandomOverride& operator=(RandomOverride&&)      = delete;
+   ~RandomOverride() { gRandom = fPrevious; }
+
+private:
+   TRandom3 fRandom;
+   TRandom* fPrevious;
+};
+
+std::string CanonicalPath(const std::string& path)
+{
+   std::array<char, PATH_MAX> buffer{};
+   if(realpath(path.c_str(), buffer.data()) == nullptr) {
+      return path;
+   }
+   return buffer.data();
+}
+}   // namespace
+
+DerivedCache::DerivedCache(std::string directory, const Calibration* calibration, std::string treeName)
+   : fDirectory(std::move(directory)), fCalibration(calibration), fTreeName(std::move(treeName))
+{
+   if(fCalibration == nullptr) {
+      std::ostringstream str;
+      str << DRED << "The derived column cache needs a calibration (--calibration)!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   gSystem->mkdir(fDirectory.c_str(), true);
+}
+
+ULong64_t DerivedCache::Hash(const std::string& file) const
+{
+   // FNV-1a hash of the canonical path, continued from the hash of the calibration
+   ULong64_t hash = fCalibration->Hash();
+   for(char c : CanonicalPath(file)) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ULL;
+   }
+   return hash;
+}
+
+std::string DerivedCache::FileName(const std::string& file) const
+{
+   ULong64_t   hash = Hash(file);
+   std::string base = file.substr(file.find_last_of('/') + 1);   // works without a slash as npos + 1 = 0
+   if(base.size() > 5 && base.compare(base.size() - 5, 5, ".root") == 0) { base.erase(base.size() - 5); }
+   std::ostringstream str;
+   str << fDirectory << "/" << base << "." << std::hex << std::setw(16) << std::setfill('0') << hash << ".derived.root";
+   return str.str();
+}
+
+std::string DerivedCache::Ensure(const std::string& file, Long64_t entries) const
+{
+   auto cacheFile = FileName(file);
+   if(!gSystem->AccessPathName(cacheFile.c_str())) {
+      TFile cache(cacheFile.c_str());
+      auto* tree = dynamic_cast<TTree*>(cache.Get(kTreeName));
+      if(tree != nullptr && tree->GetEntries() == entries) { return cacheFile; }
+      std::cout << "Derived columns in '" << cacheFile << "' are out of date, writing them again" << std::endl;
+   }
+   Write(file, cacheFile, entries);
+   return cacheFile;
+}
+
+void DerivedCache::Write(const std::string& file, const std::string& cacheFile, Long64_t entries) const
+{
+   /// The cache is written to a temporary file first and then renamed, so other runs never see a partial cache (and
+   /// since the dithering is seeded with the hash, concurrent runs writing the same cache write the same content).
+   TFile input(file.c_str());
+   auto* inputTree = dynamic_cast<TTree*>(input.Get(fTreeName.c_str()));
+   if(inputTree == nullptr) {
+      std::ostringstream str;
+      str << DRED << "Failed to find tree '" << fTreeName << "' in '" << file << "' to write the derived columns!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   TTreeReader              reader(inputTree);
+   TTreeReaderArray<double> crossAmplitude(reader, "clover_cross.amplitude");
+   TTreeReaderArray<double> crossTime(reader, "clover_cross.channel_time");
+   TTreeReaderArray<double> backAmplitude(reader, "clover_back.amplitude");
+   TTreeReaderArray<double> backTime(reader, "clover_back.channel_time");
+   TTreeReaderArray<double> miscAmplitude(reader, "misc.amplitude");
+   TTreeReaderArray<double> miscTime(reader, "misc.channel_time");
+
+   // the temporary file is unique to this process (also across machines sharing the directory), so concurrent runs
+   // writing the same cache don't overwrite each other's temporary file, the last rename wins
+   std::string temporary = cacheFile + "." + gSystem->HostName() + "." + std::to_string(gSystem->GetPid()) + ".tmp";
+   TFile       output(temporary.c_str(), "recreate");
+   // the tree belongs to the output file, which deletes it when it's closed
+   auto* tree = new TTree(kTreeName, Form("derived columns of %s", CanonicalPath(file).c_str()));
+
+   std::vector<double> crossEnergy;
+   std::vector<double> crossCalibratedTime;
+   std::vector<double> backEnergy;
+   std::vector<double> backCalibratedTime;
+   std::vector<double> miscEnergy;
+   std::vector<double> miscCalibratedTime;
+   std::vector<double> addbackEnergy;
+   std::vector<double> addbackTime;
+   std::vector<int>    addbackClover;
+   tree->Branch("clover_cross_energy", &crossEnergy);
+   tree->Branch("clover_cross_time", &crossCalibratedTime);
+   tree->Branch("clover_back_energy", &backEnergy);
+   tree->Branch("clover_back_time", &backCalibratedTime);
+   tree->Branch("misc_energy", &miscEnergy);
+   tree->Branch("misc_time", &miscCalibratedTime);
+   tree->Branch("clover_cross_addback_energy", &addbackEnergy);
+   tree->Branch("clover_cross_addback_time", &addbackTime);
+   tree->Branch("clover_cross_addback_clover", &addbackClover);
+
+   // the dithering of the calibration only depends on the input file and the calibration (a seed of 0 would use the time)
+   ULong64_t      hash = Hash(file);
+   RandomOverride random(static_cast<UInt_t>((hash ^ (hash >> 32U)) % 4294967295ULL) + 1U);
+
+   // same addback as the example helper
+   Addback addback(16, 4);
+   addback.SquareNeighbours();
+   addback.TimeGate(50.);
+
+   std::cout << "Writing derived columns of " << entries << " entries of '" << file << "' to '" << cacheFile << "'" << std::endl;
+   reader.SetEntriesRange(0, entries);
+   while(reader.Next()) {
+      Calibrate(crossAmplitude, crossTime, 0, fCalibration, crossEnergy, crossCalibratedTime);
+      Calibrate(backAmplitude, backTime, 16, fCalibration, backEnergy, backCalibratedTime);
+      Calibrate(miscAmplitude, miscTime, 32, fCalibration, miscEnergy, miscCalibratedTime);
+      addback.Process(ROOT::RVecD(crossEnergy.data(), crossEnergy.size()), ROOT::RVecD(crossCalibratedTime.data(), crossCalibratedTime.size()));
+      addbackEnergy.resize(addback.Size());
+      addbackTime.resize(addback.Size());
+      addbackClover.resize(addback.Size());
+      for(size_t hit = 0; hit < addback.Size(); ++hit) {
+         addbackEnergy[hit] = addback.Energy(hit);
+         addbackTime[hit]   = addback.Time(hit);
+         addbackClover[hit] = static_cast<int>(addback.Clover(hit));
+      }
+      tree->Fill();
+   }
+   if(reader.GetEntryStatus() != TTreeReader::kEntryBeyondEnd && reader.GetEntryStatus() != TTreeReader::kEntryValid) {
+      std::ostringstream str;
+      str << DRED << "Failed to read '" << file << "' while writing the derived columns (status " << reader.GetEntryStatus() << ")!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   tree->Write();
+   output.Close();
+   if(std::rename(temporary.c_str(), cacheFile.c_str()) != 0) {
+      std::ostringstream str;
+      str << DRED << "Failed to rename '" << temporary << "' to '" << cacheFile << "'!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+}
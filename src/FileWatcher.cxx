@@ -0,0 +1,124 @@
+#include "FileWatcher.h"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+#ifndef OS_DARWIN
+#include <sys/inotify.h>
+#endif
+
+#include "Globals.h"
+
+volatile sig_atomic_t FileWatcher::fStop = 0;
+
+FileWatcher::FileWatcher(const std::vector<std::string>& directories, std::string suffix)
+   : fSuffix(std::move(suffix)), fDirectories(directories)
+{
+#ifndef OS_DARWIN
+   fDescriptor = inotify_init1(IN_NONBLOCK);
+   if(fDescriptor < 0) {
+      std::ostringstream str;
+      str << DRED << "Failed to initialize inotify: " << std::strerror(errno) << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   for(const auto& dir : fDirectories) {
+      int watch = inotify_add_watch(fDescriptor, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+      if(watch < 0) {
+         std::ostringstream str;
+         str << DRED << "Failed to watch directory '" << dir << "': " << std::strerror(errno) << RESET_COLOR;
+         throw std::runtime_error(str.str());
+      }
+      fWatches[watch] = dir;
+   }
+#else
+   // without inotify we poll the directories, so we need to know which files are already there
+   fKnownFiles = Poll();
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+   if(fDescriptor >= 0) {
+      close(fDescriptor);
+   }
+}
+
+bool FileWatcher::Matches(const std::string& name) const
+{
+   return name.length() >= fSuffix.length() && name.compare(name.length() - fSuffix.length(), fSuffix.length(), fSuffix) == 0;
+}
+
+std::vector<std::string> FileWatcher::Wait(int timeout)
+{
+   /// Waits for at most timeout milliseconds for new files to show up in the watched directories.
+   /// Returns immediately (with an empty list) if Stop() has been called, or if a signal interrupted the wait.
+   std::vector<std::string> result;
+   if(Stopped()) { return result; }
+
+#ifndef OS_DARWIN
+   pollfd fds{fDescriptor, POLLIN, 0};
+   int    ready = poll(&fds, 1, timeout);
+   if(ready <= 0) {
+      // timeout or interrupted by a signal (EINTR), either way nothing to report
+      return result;
+   }
+
+   // read all events that are available, the buffer needs to be aligned for inotify_event
+   alignas(inotify_event) std::array<char, 4096> buffer{};
+   while(true) {
+      ssize_t length = read(fDescriptor, buffer.data(), buffer.size());
+      if(length <= 0) { break; }   // EAGAIN, we've read all events
+      for(char* ptr = buffer.data(); ptr < buffer.data() + length;) {
+         auto* event = reinterpret_cast<inotify_event*>(ptr);
+         if(event->len > 0 && Matches(event->name)) {
+            result.push_back(fWatches.at(event->wd) + "/" + event->name);
+         }
+         ptr += sizeof(inotify_event) + event->len;
+      }
+   }
+#else
+   // sleep in small steps so we can react to Stop()
+   for(int waited = 0; waited < timeout && !Stopped(); waited += 100) {
+      usleep(100000);
+   }
+   for(auto& file : Poll()) {
+      if(std::find(fKnownFiles.begin(), fKnownFiles.end(), file) == fKnownFiles.end()) {
+         fKnownFiles.push_back(file);
+         result.push_back(file);
+      }
+   }
+#endif
+
+   std::sort(result.begin(), result.end());
+   result.erase(std::unique(result.begin(), result.end()), result.end());
+
+   return result;
+}
+
+std::vector<std::string> FileWatcher::Poll()
+{
+   /// Returns all files in the watched directories that match the suffix.
+   std::vector<std::string> result;
+   for(const auto& dir : fDirectories) {
+      DIR* handle = opendir(dir.c_str());
+      if(handle == nullptr) {
+         std::cout << DRED << "Failed to open directory '" << dir << "': " << std::strerror(errno) << RESET_COLOR << std::endl;
+         continue;
+      }
+      while(dirent* entry = readdir(handle)) {
+         if(Matches(entry->d_name)) {
+            result.push_back(dir + "/" + entry->d_name);
+         }
+      }
+      closedir(handle);
+   }
+
+   return result;
+}
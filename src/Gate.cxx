@@ -0,0 +1,103 @@
+#include "Gate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "Globals.h"
+
+Gate::Gate(const TCutG* cut, int cells)
+   : fName(cut->GetName()), fCells(std::max(cells, 1))
+{
+   if(cut->GetN() < 3) {
+      std::ostringstream str;
+      str << DRED << "Cut " << cut->GetName() << " has only " << cut->GetN() << " points, can't create a gate from it!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   fX.assign(cut->GetX(), cut->GetX() + cut->GetN());
+   fY.assign(cut->GetY(), cut->GetY() + cut->GetN());
+   // make sure the polygon is closed
+   if(fX.front() != fX.back() || fY.front() != fY.back()) {
+      fX.push_back(fX.front());
+      fY.push_back(fY.front());
+   }
+
+   fMinX = *std::min_element(fX.begin(), fX.end());
+   fMaxX = *std::max_element(fX.begin(), fX.end());
+   fMinY = *std::min_element(fY.begin(), fY.end());
+   fMaxY = *std::max_element(fY.begin(), fY.end());
+   double width  = fMaxX - fMinX;
+   double height = fMaxY - fMinY;
+   fScaleX       = width > 0. ? fCells / width : 0.;
+   fScaleY       = height > 0. ? fCells / height : 0.;
+   fGrid.assign(static_cast<size_t>(fCells) * fCells, kOutside);
+
+   // mark all cells an edge passes through as boundary cells, by splitting each edge into pieces no longer than
+   // half a cell and marking all cells the bounding box of a piece overlaps (this might mark a few cells too many,
+   // but never misses one)
+   auto column = [this](double x) { return std::clamp(static_cast<int>((x - fMinX) * fScaleX), 0, fCells - 1); };
+   auto row    = [this](double y) { return std::clamp(static_cast<int>((y - fMinY) * fScaleY), 0, fCells - 1); };
+   for(size_t i = 0; i + 1 < fX.size(); ++i) {
+      double dx     = (fX[i + 1] - fX[i]) * fScaleX;
+      double dy     = (fY[i + 1] - fY[i]) * fScaleY;
+      int    pieces = static_cast<int>(std::ceil(2. * std::max(std::abs(dx), std::abs(dy)))) + 1;
+      for(int piece = 0; piece < pieces; ++piece) {
+         double x1 = fX[i] + (fX[i + 1] - fX[i]) * piece / pieces;
+         double x2 = fX[i] + (fX[i + 1] - fX[i]) * (piece + 1) / pieces;
+         double y1 = fY[i] + (fY[i + 1] - fY[i]) * piece / pieces;
+         double y2 = fY[i] + (fY[i + 1] - fY[i]) * (piece + 1) / pieces;
+         for(int r = row(std::min(y1, y2)); r <= row(std::max(y1, y2)); ++r) {
+            for(int c = column(std::min(x1, x2)); c <= column(std::max(x1, x2)); ++c) {
+               fGrid[static_cast<size_t>(r) * fCells + c] = kBoundary;
+            }
+         }
+      }
+   }
+
+   // all other cells are either completely inside or outside, so testing the center is enough
+   for(int r = 0; r < fCells; ++r) {
+      for(int c = 0; c < fCells; ++c) {
+         auto& cell = fGrid[static_cast<size_t>(r) * fCells + c];
+         if(cell == kBoundary) { continue; }
+         double x = fMinX + (c + 0.5) / fScaleX;
+         double y = fMinY + (r + 0.5) / fScaleY;
+         cell     = IsInsidePolygon(x, y) ? kInside : kOutside;
+      }
+   }
+}
+
+bool Gate::IsInsidePolygon(double x, double y) const
+{
+   bool inside = false;
+   for(size_t i = 0, j = fX.size() - 1; i < fX.size(); j = i++) {
+      if(((fY[i] > y) != (fY[j] > y)) && (x < (fX[j] - fX[i]) * (y - fY[i]) / (fY[j] - fY[i]) + fX[i])) {
+         inside = !inside;
+      }
+   }
+   return inside;
+}
+
+void Gate::IsInside(const ROOT::RVecD& x, const ROOT::RVecD& y, ROOT::RVec<char>& result) const
+{
+   const size_t size = std::min(x.size(), y.size());
+   result.resize(size);
+   for(size_t i = 0; i < size; ++i) {
+      result[i] = IsInside(x[i], y[i]) ? 1 : 0;
+   }
+}
+
+size_t Gate::Count(const ROOT::RVecD& x, const ROOT::RVecD& y) const
+{
+   const size_t size  = std::min(x.size(), y.size());
+   size_t       count = 0;
+   for(size_t i = 0; i < size; ++i) {
+      count += IsInside(x[i], y[i]) ? 1 : 0;
+   }
+   return count;
+}
+
+double Gate::BoundaryFraction() const
+{
+   return static_cast<double>(std::count(fGrid.begin(), fGrid.end(), kBoundary)) / static_cast<double>(fGrid.size());
+}
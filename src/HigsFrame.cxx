@@ -15,6 +15,7 @@
 #include "Options.h"
 #include "Redirect.h"
 #include "BasicFrame.h"
+#include "PerfReport.h"
 
 int main(int argc, char** argv)
 {
@@ -51,6 +52,64 @@ int main(int argc, char** argv)
          options->MaxWorkers(std::stoi(argv[++i]));
          continue;
       }
+      if(strcmp(argv[i], "--follow") == 0 || strcmp(argv[i], "-f") == 0) {
+         options->Follow(true);
+         continue;
+      }
+      if(strcmp(argv[i], "--perf-report") == 0 || strcmp(argv[i], "-p") == 0) {
+         options->PerfReportFile(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--profile") == 0 || strcmp(argv[i], "-P") == 0) {
+         options->Profile(true);
+         continue;
+      }
+      if(strcmp(argv[i], "--memory-policy") == 0 || strcmp(argv[i], "-m") == 0) {
+         options->MemoryPolicy(argv[++i]);
+         if(options->MemoryPolicy() != "report" && options->MemoryPolicy() != "refuse" && options->MemoryPolicy() != "cap") {
+            std::cerr << "Unknown memory policy \"" << options->MemoryPolicy() << "\", should be report, refuse, or cap!" << std::endl;
+            parseError = true;
+         }
+         continue;
+      }
+      if(strcmp(argv[i], "--numa") == 0 || strcmp(argv[i], "-n") == 0) {
+         options->Numa(true);
+         continue;
+      }
+      if(strcmp(argv[i], "--parallel-unzip") == 0 || strcmp(argv[i], "-u") == 0) {
+         options->ParallelUnzip(true);
+         continue;
+      }
+      if(strcmp(argv[i], "--mmap") == 0 || strcmp(argv[i], "-x") == 0) {
+         options->MmapAdvice(argv[++i]);
+         if(options->MmapAdvice() != "sequential" && options->MmapAdvice() != "willneed") {
+            std::cerr << "Unknown mmap hint \"" << options->MmapAdvice() << "\", should be sequential or willneed!" << std::endl;
+            parseError = true;
+         }
+         continue;
+      }
+      if(strcmp(argv[i], "--histograms") == 0 || strcmp(argv[i], "-g") == 0) {
+         options->HistogramFile(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--derived-cache") == 0 || strcmp(argv[i], "-D") == 0) {
+         options->DerivedCache(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--entry-list") == 0 || strcmp(argv[i], "-e") == 0) {
+         options->EntryList(argv[++i]);
+         continue;
+      }
+      if(strcmp(argv[i], "--time-range") == 0 || strcmp(argv[i], "-T") == 0) {
+         double low  = std::stod(argv[++i]);
+         double high = std::stod(argv[++i]);
+         options->TimeRange(low, high);
+         continue;
+      }
+      if(strcmp(argv[i], "--monitor") == 0 || strcmp(argv[i], "-M") == 0) {
+         options->MonitorInterval(std::stod(argv[++i]));
+         continue;
+      }
       if(strcmp(argv[i], "--debug") == 0 || strcmp(argv[i], "-d") == 0) {
          options->Debug(true);
          continue;
@@ -69,6 +128,15 @@ int main(int argc, char** argv)
       parseError = true;
    }
 
+   if(options->Follow() && (!options->EntryList().empty() || options->TimeRange())) {
+      std::cerr << "An entry list or time range can't be used in follow mode!" << std::endl;
+      parseError = true;
+   }
+   if(!options->EntryList().empty() && options->TimeRange()) {
+      std::cerr << "An entry list and a time range can't be used together!" << std::endl;
+      parseError = true;
+   }
+
    if(parseError) {
       std::cout << "Commandline arguments for " << argv[0] << ":" << std::endl
                 << "--input        <input root-file>                        needed" << std::endl
@@ -77,6 +145,18 @@ int main(int argc, char** argv)
                 << "--max-workers  <maximum number of threads>              optional" << std::endl
                 << "--output       <output root-file>                       optional" << std::endl
                 << "--tree-name    <name of root tree>                      optional" << std::endl
+                << "--follow       no argument, keeps processing new files  optional" << std::endl
+                << "--perf-report  <json file for performance report>       optional" << std::endl
+                << "--profile      no argument, enables helper profiling    optional" << std::endl
+                << "--memory-policy <report, refuse, or cap>                optional" << std::endl
+                << "--numa         no argument, pins slots to NUMA nodes    optional" << std::endl
+                << "--parallel-unzip no argument, unzips baskets ahead      optional" << std::endl
+                << "--mmap         <sequential or willneed>, maps inputs    optional" << std::endl
+                << "--histograms   <file with histogram definitions>        optional" << std::endl
+                << "--derived-cache <directory for cached derived columns>  optional" << std::endl
+                << "--entry-list   <entry list written by a helper>         optional" << std::endl
+                << "--time-range   <low> <high> extended timestamp          optional" << std::endl
+                << "--monitor      <seconds between histogram snapshots>    optional (without matrices and cubes)" << std::endl
                 << "--debug        no argument, enables debugging messages  optional" << std::endl;
       return 1;
    }
@@ -111,12 +191,20 @@ int main(int argc, char** argv)
    BasicFrame frame(options);
    // run it and write the results
    frame.Run(redirect);
+   // in follow mode we keep processing new data until we get interrupted
+   if(options->Follow()) {
+      frame.Follow(redirect);
+   }
 
    // re-start redirect of stdout only w/ appending if needed (ends when we delete it)
    if(redirect == nullptr) {
       redirect = new Redirect(logFileName.c_str(), nullptr, true);
    }
 
+   if(!options->PerfReportFile().empty()) {
+      PerfReport::Get()->Write(options->PerfReportFile());
+   }
+
    // print time it took to run
    double realTime = stopwatch->RealTime();
    int    hour     = static_cast<int>(realTime / 3600);
@@ -0,0 +1,117 @@
+#include "HistogramDefinitions.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "TH1F.h"
+#include "TH1D.h"
+#include "TH1I.h"
+#include "TH2F.h"
+#include "TH2D.h"
+#include "TH2I.h"
+#include "TH3F.h"
+#include "TH3D.h"
+#include "TH3I.h"
+
+#include "Globals.h"
+
+namespace {
+template <typename Map, typename Hist>
+void Insert(Map& map, const std::string& key, Hist* hist)
+{
+   /// Replaces a histogram with the same key (keeping its position), or adds the histogram at the end.
+   auto it = map.find(key);
+   if(it != map.end()) {
+      delete it->second;
+      it->second = hist;
+   } else {
+      map[key] = hist;
+   }
+}
+}   // namespace
+
+HistogramDefinitions::HistogramDefinitions(const std::string& fileName)
+   : fFileName(fileName)
+{
+   std::ifstream input(fileName);
+   if(!input.is_open()) {
+      std::ostringstream str;
+      str << DRED << "Failed to open histogram definitions \"" << fileName << "\"!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   std::string line;
+   int         lineNumber = 0;
+   while(std::getline(input, line)) {
+      ++lineNumber;
+      auto first = line.find_first_not_of(" \t");
+      if(first == std::string::npos || line[first] == '#') { continue; }
+      std::istringstream str(line);
+      Definition         definition;
+      str >> definition.fType >> definition.fKey;
+      // TH1F, TH2D, ... the digit is the number of axes
+      size_t axes = 0;
+      if(definition.fType.size() == 4 && definition.fType.compare(0, 2, "TH") == 0 && definition.fType[2] >= '1' && definition.fType[2] <= '3' &&
+         (definition.fType[3] == 'F' || definition.fType[3] == 'D' || definition.fType[3] == 'I')) {
+         axes = definition.fType[2] - '0';
+      }
+      definition.fAxes.resize(axes);
+      for(auto& axis : definition.fAxes) {
+         str >> axis.fBins >> axis.fLow >> axis.fHigh;
+      }
+      if(axes == 0 || definition.fKey.empty() || str.fail() || definition.fAxes.back().fBins <= 0) {
+         std::ostringstream error;
+         error << DRED << fileName << ":" << lineNumber << ": failed to parse histogram definition \"" << line << "\", expected <TH1F, TH2D, ...> <key> and bins, low, and high for each axis!" << RESET_COLOR;
+         throw std::runtime_error(error.str());
+      }
+      // the rest of the line is the title
+      std::getline(str >> std::ws, definition.fTitle);
+      auto lastSlash   = definition.fKey.find_last_of('/');
+      definition.fName = (lastSlash == std::string::npos ? definition.fKey : definition.fKey.substr(lastSlash + 1));
+      if(definition.fTitle.empty()) { definition.fTitle = definition.fName; }
+      fDefinitions.push_back(definition);
+   }
+   std::cout << "Read " << fDefinitions.size() << " histogram definition(s) from \"" << fileName << "\"" << std::endl;
+}
+
+TH1* HistogramDefinitions::Create(const Definition& definition)
+{
+   const char*       name  = definition.fName.c_str();
+   const char*       title = definition.fTitle.c_str();
+   const auto&       axes  = definition.fAxes;
+   const auto&       type  = definition.fType;
+   // NOLINTBEGIN(cppcoreguidelines-pro-bounds-constant-array-index)
+   if(type == "TH1F") { return new TH1F(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh); }
+   if(type == "TH1D") { return new TH1D(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh); }
+   if(type == "TH1I") { return new TH1I(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh); }
+   if(type == "TH2F") { return new TH2F(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh, axes[1].fBins, axes[1].fLow, axes[1].fHigh); }
+   if(type == "TH2D") { return new TH2D(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh, axes[1].fBins, axes[1].fLow, axes[1].fHigh); }
+   if(type == "TH2I") { return new TH2I(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh, axes[1].fBins, axes[1].fLow, axes[1].fHigh); }
+   if(type == "TH3F") { return new TH3F(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh, axes[1].fBins, axes[1].fLow, axes[1].fHigh, axes[2].fBins, axes[2].fLow, axes[2].fHigh); }
+   if(type == "TH3D") { return new TH3D(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh, axes[1].fBins, axes[1].fLow, axes[1].fHigh, axes[2].fBins, axes[2].fLow, axes[2].fHigh); }
+   return new TH3I(name, title, axes[0].fBins, axes[0].fLow, axes[0].fHigh, axes[1].fBins, axes[1].fLow, axes[1].fHigh, axes[2].fBins, axes[2].fLow, axes[2].fHigh);
+   // NOLINTEND(cppcoreguidelines-pro-bounds-constant-array-index)
+}
+
+void HistogramDefinitions::Create(CustomMap<std::string, TH1*>& h1, CustomMap<std::string, TH2*>& h2, CustomMap<std::string, TH3*>& h3) const
+{
+   for(const auto& definition : fDefinitions) {
+      const auto& key  = definition.fKey;
+      auto        axes = definition.fAxes.size();
+      // a key can only be used by one dimension, otherwise the histograms would overwrite each other in the output
+      if((axes != 1 && h1.count(key) == 1) || (axes != 2 && h2.count(key) == 1) || (axes != 3 && h3.count(key) == 1)) {
+         std::ostringstream str;
+         str << DRED << fFileName << ": \"" << key << "\" is defined as " << definition.fType << ", but the helper already has a histogram with a different dimension with this key!" << RESET_COLOR;
+         throw std::runtime_error(str.str());
+      }
+      auto* hist = Create(definition);
+      if(axes == 1) {
+         Insert(h1, key, hist);
+      } else if(axes == 2) {
+         Insert(h2, key, static_cast<TH2*>(hist));
+      } else {
+         Insert(h3, key, static_cast<TH3*>(hist));
+      }
+   }
+}
@@ -0,0 +1,76 @@
+#include "HitEvent.h"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "Globals.h"
+
+std::vector<std::vector<std::unique_ptr<HitEvent>>>& HitEvent::Events()
+{
+   static std::vector<std::vector<std::unique_ptr<HitEvent>>> events;
+   return events;
+}
+
+void HitEvent::Slots(unsigned int nSlots)
+{
+   // only ever grows, so the events of slots in use are never deleted
+   auto& events = Events();
+   if(events.size() < nSlots) {
+      events.resize(nSlots);
+   }
+}
+
+void HitEvent::NewLoop()
+{
+   for(auto& slot : Events()) {
+      for(auto& event : slot) {
+         event->fBuilt = false;
+      }
+   }
+}
+
+HitEvent& HitEvent::ForSlot(unsigned int slot, const Calibration* calibration, const std::string& layout)
+{
+   // each slot is only used by one thread at a time, and there are only a few helpers, so a linear search is enough
+   auto& events = Events()[slot];
+   for(auto& event : events) {
+      if(event->fCalibration == calibration && event->fLayout == layout) { return *event; }
+   }
+   events.emplace_back(new HitEvent(calibration, layout));
+   return *events.back();
+}
+
+HitEvent::HitEvent(const Calibration* calibration, std::string layout)
+   : fCalibration(calibration), fLayout(std::move(layout))
+{
+   // enough for all detectors of the example helper, the buffers grow if needed
+   fEnergy.reserve(64);
+   fTime.reserve(64);
+   fId.reserve(64);
+   fType.reserve(64);
+}
+
+void HitEvent::Add(uint8_t type, uint16_t firstId, const ROOT::RVecD& value, const ROOT::RVecD& time, const Calibration* calibration)
+{
+   if(type >= kMaxTypes) {
+      std::ostringstream str;
+      str << DRED << "Detector type " << static_cast<int>(type) << " is out of range, only " << kMaxTypes << " detector types are supported!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   fTypeBegin[type] = fEnergy.size();
+   for(size_t i = 0; i < value.size(); ++i) {
+      if(std::isnan(value[i])) { continue; }
+      auto id = static_cast<uint16_t>(firstId + i);
+      fEnergy.push_back(calibration != nullptr ? calibration->Energy(value[i], id) : value[i]);
+      if(i < time.size()) {
+         fTime.push_back(calibration != nullptr ? calibration->Time(time[i]) : time[i]);
+      } else {
+         fTime.push_back(NAN);
+      }
+      fId.push_back(id);
+      fType.push_back(type);
+   }
+   fTypeEnd[type] = fEnergy.size();
+}
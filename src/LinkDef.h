@@ -1,4 +1,4 @@
-// BasicFrame.h BasicHelper.h DataFrameLibrary.h
+// BasicFrame.h BasicHelper.h DataFrameLibrary.h Calibration.h PerfReport.h SymmetricMatrix.h SymmetricCube.h TiledHistogram.h ZoneMap.h MappedFile.h
 
 #ifdef __CINT__
 
@@ -9,5 +9,11 @@
 
 #pragma link C++ class DataFrameLibrary + ;
 #pragma link C++ class Calibration + ;
+#pragma link C++ class PerfReport + ;
+#pragma link C++ class SymmetricMatrix + ;
+#pragma link C++ class SymmetricCube + ;
+#pragma link C++ class TiledHistogram + ;
+#pragma link C++ class ZoneMap + ;
+#pragma link C++ class MappedFile + ;
 
 #endif
@@ -0,0 +1,141 @@
+#include "Logger.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Globals.h"
+
+Logger& Logger::Get()
+{
+   static Logger logger;
+   return logger;
+}
+
+size_t Logger::RegisterSite(const char* file, int line)
+{
+   std::lock_guard<std::mutex> lock(fMutex);
+   fSites.push_back(std::string(file) + ":" + std::to_string(line));
+   return fSites.size() - 1;
+}
+
+void Logger::Open(const char* fileName, unsigned int nSlots)
+{
+   if(IsOpen()) {
+      Close();
+   }
+   if(fileName == nullptr) {
+      return;
+   }
+   fSlots.clear();
+   for(unsigned int slot = 0; slot < nSlots; ++slot) {
+      fSlots.emplace_back(new SlotData(fCapacity));
+   }
+   fFileDescriptor = open(fileName, O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+   if(fFileDescriptor < 0) {
+      std::cerr << DRED << "Failed to open log file " << fileName << ", logging to stdout instead" << RESET_COLOR << std::endl;
+      fSlots.clear();
+      return;
+   }
+   fRunning = true;
+   fThread  = std::thread(&Logger::Drain, this);
+}
+
+void Logger::Close()
+{
+   if(!IsOpen()) {
+      return;
+   }
+   fRunning = false;
+   if(fThread.joinable()) {
+      fThread.join();
+   }
+
+   // summary of all call sites that logged anything, and of all messages dropped
+   std::vector<uint64_t> counts;
+   uint64_t              dropped = 0;
+   for(auto& slot : fSlots) {
+      if(counts.size() < slot->fCounts.size()) { counts.resize(slot->fCounts.size(), 0); }
+      for(size_t site = 0; site < slot->fCounts.size(); ++site) {
+         counts[site] += slot->fCounts[site];
+      }
+      dropped += slot->fDropped;
+   }
+   std::ostringstream str;
+   for(size_t site = 0; site < counts.size(); ++site) {
+      if(counts[site] == 0) { continue; }
+      uint64_t suppressed = 0;
+      for(auto& slot : fSlots) {
+         if(site < slot->fCounts.size() && slot->fCounts[site] > fLimit) { suppressed += slot->fCounts[site] - fLimit; }
+      }
+      str << "Logger summary: " << fSites[site] << " logged " << counts[site] << " messages";
+      if(suppressed > 0) {
+         str << ", " << suppressed << " of them suppressed (limit of " << fLimit << " per slot)";
+      }
+      str << std::endl;
+   }
+   if(dropped > 0) {
+      str << "Logger summary: dropped " << dropped << " messages because the buffers were full" << std::endl;
+   }
+   Write(str.str());
+
+   close(fFileDescriptor);
+   fFileDescriptor = -1;
+   fSlots.clear();
+}
+
+void Logger::Drain()
+{
+   /// Writes all messages of all slots to the file until the logger gets closed (and once more after that).
+   std::string message;
+   bool        running = true;
+   while(running) {
+      // read the flag before draining, so no message pushed before Close is missed
+      running  = fRunning;
+      auto now = std::chrono::steady_clock::now();
+      std::ostringstream str;
+      EndWindows(str, now, false);
+      for(size_t slot = 0; slot < fSlots.size(); ++slot) {
+         auto& data = *fSlots[slot];
+         while(data.Pop(message)) {
+            // the message is the key, so repeats from other slots (which are interleaved) are caught as well
+            auto repeats = fRepeats.find(message);
+            if(repeats != fRepeats.end()) {
+               ++repeats->second.fCount;
+               continue;
+            }
+            str << slot << ": " << message << std::endl;
+            fRepeats.emplace(std::move(message), Repeats{now, 0});
+         }
+      }
+      if(!running) { EndWindows(str, now, true); }
+      Write(str.str());
+      if(running) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+   }
+}
+
+void Logger::EndWindows(std::ostringstream& str, std::chrono::steady_clock::time_point now, bool all)
+{
+   for(auto it = fRepeats.begin(); it != fRepeats.end();) {
+      if(!all && now - it->second.fFirst < fWindow) {
+         ++it;
+         continue;
+      }
+      if(it->second.fCount > 0) {
+         str << "message \"" << it->first << "\" repeated " << it->second.fCount << " times within " << fWindow.count() << " s" << std::endl;
+      }
+      it = fRepeats.erase(it);
+   }
+}
+
+void Logger::Write(const std::string& text)
+{
+   size_t written = 0;
+   while(written < text.size()) {
+      auto result = write(fFileDescriptor, text.data() + written, text.size() - written);
+      if(result <= 0) { return; }
+      written += static_cast<size_t>(result);
+   }
+}
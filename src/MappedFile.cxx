@@ -0,0 +1,106 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "TROOT.h"
+#include "TPluginManager.h"
+
+#include "Globals.h"
+
+int                   MappedFile::fgAdvice = MADV_SEQUENTIAL;
+std::atomic<Long64_t> MappedFile::fgMappedReads{0};
+std::atomic<Long64_t> MappedFile::fgMappedBytes{0};
+
+void MappedFile::Enable(const std::string& advice)
+{
+   if(advice == "sequential") {
+      fgAdvice = MADV_SEQUENTIAL;
+   } else if(advice == "willneed") {
+      fgAdvice = MADV_WILLNEED;
+   } else {
+      std::ostringstream str;
+      str << DRED << "Unknown mmap hint \"" << advice << "\", should be sequential or willneed!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   gROOT->GetPluginManager()->AddHandler("TFile", "^mmap:", "MappedFile", "Higs", "MappedFile(const char*,Option_t*,const char*,Int_t)");
+   std::cout << "Reading local input files through memory mappings (" << advice << ")" << std::endl;
+}
+
+std::string MappedFile::LocalPath(const char* url)
+{
+   std::string path = url;
+   if(path.compare(0, std::strlen(kProtocol), kProtocol) == 0) { path.erase(0, std::strlen(kProtocol)); }
+   return path;
+}
+
+MappedFile::MappedFile(const char* url, Option_t* option, const char* title, Int_t compress)
+   : TFile(LocalPath(url).c_str(), option, title, compress)
+{
+   /// TFile has opened the file and read its header at this point, all further reads can use the mapping.
+   if(IsZombie() || IsWritable()) { return; }
+   struct stat status {};
+   if(fstat(fD, &status) != 0 || status.st_size == 0) { return; }
+   void* map = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fD, 0);
+   if(map == MAP_FAILED) {
+      std::cout << DYELLOW << "Failed to map '" << GetName() << "': " << std::strerror(errno) << ", reading it without mapping" << RESET_COLOR << std::endl;
+      return;
+   }
+   madvise(map, status.st_size, fgAdvice);
+   fMap  = static_cast<const char*>(map);
+   fSize = status.st_size;
+}
+
+MappedFile::~MappedFile()
+{
+   if(fMap != nullptr) { munmap(const_cast<char*>(fMap), fSize); }   // NOLINT(cppcoreguidelines-pro-type-const-cast)
+}
+
+Bool_t MappedFile::ReadBuffer(char* buf, Int_t len)
+{
+   return ReadBuffer(buf, fOffset, len);
+}
+
+Bool_t MappedFile::ReadBuffer(char* buf, Long64_t pos, Int_t len)
+{
+   /// Returns kTRUE in case of failure (like TFile).
+   if(!Covers(pos, len)) { return TFile::ReadBuffer(buf, pos, len); }
+   // the tree cache might already have this buffer
+   SetOffset(pos);
+   Int_t status = ReadBufferViaCache(buf, len);
+   if(status != 0) { return status == 2; }
+   std::memcpy(buf, fMap + pos, len);
+   SetOffset(pos + len);
+   Count(1, len);
+   return kFALSE;
+}
+
+Bool_t MappedFile::ReadBuffers(char* buf, Long64_t* pos, Int_t* len, Int_t nbuf)
+{
+   /// Reads nbuf buffers into buf one after the other (this is what the tree cache uses). Returns kTRUE in case of failure.
+   if(buf == nullptr) { return TFile::ReadBuffers(buf, pos, len, nbuf); }
+   for(Int_t i = 0; i < nbuf; ++i) {
+      if(!Covers(pos[i], len[i])) { return TFile::ReadBuffers(buf, pos, len, nbuf); }
+   }
+   Long64_t bytes = 0;
+   for(Int_t i = 0; i < nbuf; ++i) {
+      std::memcpy(buf + bytes, fMap + pos[i], len[i]);
+      bytes += len[i];
+   }
+   Count(nbuf, bytes);
+   return kFALSE;
+}
+
+void MappedFile::Count(Long64_t reads, Long64_t bytes)
+{
+   /// The global counters of TFile are left alone, they count the bytes and calls of real reads, and updating them from
+   /// here wouldn't be atomic. The performance report adds the mapped bytes to the bytes read instead.
+   fBytesRead += bytes;
+   fgMappedReads += reads;
+   fgMappedBytes += bytes;
+}
@@ -0,0 +1,203 @@
+#include "MemoryPlanner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "TH1.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TBufferFile.h"
+
+#include "Globals.h"
+#include "BasicHelper.h"
+#include "SymmetricMatrix.h"
+#include "SymmetricCube.h"
+#include "TiledHistogram.h"
+
+namespace {
+/// Reads a single number from a file, returns -1 if the file doesn't exist or doesn't contain a number (e.g. "max").
+Long64_t ReadNumber(const std::string& path)
+{
+   std::ifstream file(path);
+   Long64_t      number = -1;
+   if(!(file >> number)) { return -1; }
+   return number;
+}
+
+/// Remaining memory of our cgroup (limit - usage) in bytes, -1 if there is no limit.
+Long64_t CgroupRemaining()
+{
+   // cgroup v2: the line "0::<path>" of /proc/self/cgroup gives our cgroup, in a container that is usually just "/"
+   std::string   path = "/sys/fs/cgroup";
+   std::ifstream cgroup("/proc/self/cgroup");
+   std::string   line;
+   while(std::getline(cgroup, line)) {
+      if(line.compare(0, 3, "0::") == 0 && line.size() > 4) {
+         path += line.substr(3);
+         break;
+      }
+   }
+   Long64_t limit = ReadNumber(path + "/memory.max");
+   Long64_t usage = ReadNumber(path + "/memory.current");
+   if(limit < 0) {
+      limit = ReadNumber("/sys/fs/cgroup/memory.max");
+      usage = ReadNumber("/sys/fs/cgroup/memory.current");
+   }
+   if(limit < 0) {
+      // cgroup v1 (no limit is reported as a huge number)
+      limit = ReadNumber("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+      usage = ReadNumber("/sys/fs/cgroup/memory/memory.usage_in_bytes");
+      if(limit >= (1LL << 60)) { limit = -1; }
+   }
+   if(limit < 0) { return -1; }
+   return std::max(limit - std::max(usage, 0LL), 0LL);
+}
+
+/// Size of the basket buffers of the branch and all its sub-branches.
+Long64_t BasketSize(TObjArray* branches)
+{
+   Long64_t size = 0;
+   for(auto&& obj : *branches) {
+      auto* branch = static_cast<TBranch*>(obj);
+      size += branch->GetBasketSize();
+      size += BasketSize(branch->GetListOfBranches());
+   }
+   return size;
+}
+
+std::string GB(Long64_t bytes)
+{
+   std::ostringstream str;
+   str << std::fixed << std::setprecision(2) << static_cast<double>(bytes) / 1024. / 1024. / 1024. << " GB";
+   return str.str();
+}
+}   // namespace
+
+MemoryPlanner::EPolicy MemoryPlanner::Policy(const std::string& name)
+{
+   if(name == "report") { return EPolicy::kReport; }
+   if(name == "refuse") { return EPolicy::kRefuse; }
+   if(name == "cap") { return EPolicy::kCap; }
+   std::ostringstream str;
+   str << DRED << "Unknown memory policy '" << name << "', should be one of 'report', 'refuse', or 'cap'!" << RESET_COLOR;
+   throw std::runtime_error(str.str());
+}
+
+Long64_t MemoryPlanner::Available()
+{
+   Long64_t      available = -1;
+   std::ifstream meminfo("/proc/meminfo");
+   std::string   key;
+   Long64_t      value = 0;
+   std::string   unit;
+   while(meminfo >> key >> value) {
+      std::getline(meminfo, unit);
+      if(key == "MemAvailable:") {
+         available = value * 1024;   // in kB
+         break;
+      }
+   }
+   Long64_t cgroup = CgroupRemaining();
+   if(cgroup >= 0 && (available < 0 || cgroup < available)) { available = cgroup; }
+   return available;
+}
+
+Long64_t MemoryPlanner::Resident()
+{
+   std::ifstream statm("/proc/self/statm");
+   Long64_t      size     = 0;
+   Long64_t      resident = 0;
+   if(!(statm >> size >> resident)) { return 0; }
+   return resident * sysconf(_SC_PAGESIZE);
+}
+
+void MemoryPlanner::Estimate(const std::map<std::string, TList>& lists, bool prototype)
+{
+   fPrototype = prototype;
+   Long64_t largest = 0;
+   bool     tiled   = false;
+   for(const auto& list : lists) {
+      for(const auto&& obj : list.second) {
+         Long64_t size = 0;
+         if(obj->InheritsFrom(SymmetricMatrix::Class())) {
+            const auto* matrix = static_cast<SymmetricMatrix*>(obj);
+            size               = static_cast<Long64_t>(matrix->Bytes());
+            fHistograms += size;
+            // expanded to a TH2F at the end of Finalize
+            fMergePeak += static_cast<Long64_t>(matrix->Bins() + 2) * (matrix->Bins() + 2) * static_cast<Long64_t>(sizeof(float));
+         } else if(obj->InheritsFrom(SymmetricCube::Class())) {
+            const auto* cube = static_cast<SymmetricCube*>(obj);
+            size             = static_cast<Long64_t>(cube->Bytes());
+            fHistograms += size;
+            if(cube->ExpandedBytes() <= static_cast<size_t>(BasicHelper::SizeLimit())) { fMergePeak += static_cast<Long64_t>(cube->ExpandedBytes()); }
+         } else if(obj->InheritsFrom(TH1::Class())) {
+            size = TiledHistogram::Size(static_cast<TH1*>(obj));
+            fHistograms += size;
+            if(size > BasicHelper::SizeLimit()) { tiled = true; }
+         } else if(obj->InheritsFrom(TTree::Class())) {
+            size = BasketSize(static_cast<TTree*>(obj)->GetListOfBranches());
+            fTrees += size;
+         } else {
+            TBufferFile buf(TBuffer::kWrite, 10000);
+            obj->IsA()->WriteBuffer(buf, obj);
+            size = buf.Length();
+            fOther += size;
+         }
+         if(size <= BasicHelper::SizeLimit()) { largest = std::max(largest, size); }
+         fObjects.emplace_back(list.first.empty() ? obj->GetName() : list.first + "/" + obj->GetName(), size);
+      }
+   }
+   // CheckSizes streams each object that can be written as one into a buffer, tiled histograms need one tile at a time
+   fMergePeak += std::max(largest, tiled ? TiledHistogram::kTileSize : 0);
+   // the objects of the slot we used for the estimate are already part of the resident memory
+   fResident = std::max(Resident() - PerSlot(), 0LL);
+   std::sort(fObjects.begin(), fObjects.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+}
+
+int MemoryPlanner::Plan(int slots, EPolicy policy)
+{
+   Long64_t available = Available();
+   std::cout << "Memory plan for " << slots << " slot(s)" << (fPrototype ? " plus the prototype" : "") << ":" << std::endl
+             << "   histograms per slot   " << GB(fHistograms) << std::endl
+             << "   tree buffers per slot " << GB(fTrees) << std::endl
+             << "   other objects         " << GB(fOther) << std::endl
+             << "   peak of Finalize      " << GB(fMergePeak) << " (without merged trees)" << std::endl
+             << "   process               " << GB(fResident) << std::endl
+             << "   total                 " << GB(Total(slots)) << std::endl
+             << "   available             " << (available < 0 ? "unknown" : GB(available)) << std::endl;
+   for(size_t i = 0; i < fObjects.size() && i < 5; ++i) {
+      std::cout << "   " << std::setw(22) << std::left << (i == 0 ? "largest objects" : "") << fObjects[i].first << ": " << GB(fObjects[i].second) << std::endl;
+   }
+   std::cout << std::right;
+
+   // the available memory doesn't include what this process already uses
+   if(available < 0 || Needed(slots) <= kUsable * static_cast<double>(available)) { return slots; }
+
+   std::ostringstream str;
+   str << "Estimated additional memory of " << GB(Needed(slots)) << " for " << slots << " slot(s) exceeds " << kUsable * 100. << " % of the available " << GB(available);
+   switch(policy) {
+   case EPolicy::kReport:
+      std::cout << DRED << str.str() << ", this run might get killed!" << RESET_COLOR << std::endl;
+      std::cerr << DRED << str.str() << ", this run might get killed!" << RESET_COLOR << std::endl;
+      return slots;
+   case EPolicy::kRefuse:
+      str << ", refusing to run (use --memory-policy report to run anyway)!";
+      throw std::runtime_error(DRED + str.str() + RESET_COLOR);
+   case EPolicy::kCap:
+      break;
+   }
+   int capped = slots;
+   while(capped > 1 && Needed(capped) > kUsable * static_cast<double>(available)) {
+      --capped;
+   }
+   str << ", reducing the number of workers to " << capped;
+   if(Needed(capped) > kUsable * static_cast<double>(available)) { str << " (which still doesn't fit)"; }
+   std::cout << DYELLOW << str.str() << RESET_COLOR << std::endl;
+   std::cerr << DYELLOW << str.str() << RESET_COLOR << std::endl;
+   return capped;
+}
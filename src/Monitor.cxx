@@ -0,0 +1,103 @@
+#include "Monitor.h"
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TDirectory.h"
+
+#include "Globals.h"
+
+Monitor::Monitor(double interval, std::string fileName, std::function<Histograms()> collect)
+   : fInterval(interval), fFileName(std::move(fileName)), fCollect(std::move(collect))
+{
+   std::cout << "Writing a snapshot of all histograms to '" << fFileName << "' every " << fInterval << " s" << std::endl;
+   // the thread creates and writes files while the slots and the main thread use ROOT as well, which without implicit
+   // multi threading (--max-workers 0) isn't thread safe yet
+   ROOT::EnableThreadSafety();
+   fThread = std::thread(&Monitor::Run, this);
+}
+
+Monitor::~Monitor()
+{
+   Stop();
+}
+
+void Monitor::Stop()
+{
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fStop = true;
+   }
+   fCondition.notify_all();
+   if(fThread.joinable()) {
+      fThread.join();
+      std::cout << "Wrote " << fSnapshots << " snapshot(s) to '" << fFileName << "'" << std::endl;
+   }
+}
+
+void Monitor::Run()
+{
+   std::unique_lock<std::mutex> lock(fMutex);
+   while(!fCondition.wait_for(lock, std::chrono::duration<double>(fInterval), [this]() { return fStop; })) {
+      // the slots don't need the lock, but Stop does, so we release it while the snapshot is written
+      lock.unlock();
+      try {
+         Snapshot();
+      } catch(std::exception& e) {
+         std::cerr << DRED << "Failed to write snapshot to '" << fFileName << "': " << e.what() << RESET_COLOR << std::endl;
+      }
+      lock.lock();
+   }
+}
+
+void Monitor::Snapshot()
+{
+   // merged histograms must not be added to any directory
+   TDirectory::TContext context(nullptr);
+
+   for(auto& hists : fCollect()) {
+      if(hists.second.empty()) { continue; }
+      double entries = 0.;
+      for(auto* hist : hists.second) {
+         entries += hist->GetEntries();
+      }
+      auto& merged = fMerged[hists.first];
+      if(merged != nullptr && entries == fEntries[hists.first]) { continue; }
+      if(merged == nullptr) {
+         merged.reset(static_cast<TH1*>(hists.second[0]->Clone()));
+         merged->SetDirectory(nullptr);
+      }
+      merged->Reset();
+      for(auto* hist : hists.second) {
+         merged->Add(hist);
+      }
+      fEntries[hists.first] = entries;
+   }
+
+   // written to a temporary file first, so the snapshot file is never incomplete
+   std::string temporary = fFileName + ".tmp";
+   {
+      TFile file(temporary.c_str(), "recreate");
+      if(file.IsZombie()) { return; }
+      for(auto& merged : fMerged) {
+         // if the key contains a forward slash we write the histogram into that directory
+         auto lastSlash = merged.first.find_last_of('/');
+         if(lastSlash == std::string::npos) {
+            file.cd();
+         } else {
+            auto path = merged.first.substr(0, lastSlash);
+            if(file.GetDirectory(path.c_str()) == nullptr) { file.mkdir(path.c_str()); }
+            file.cd(path.c_str());
+         }
+         merged.second->Write();
+      }
+      file.Close();
+   }
+   std::rename(temporary.c_str(), fFileName.c_str());
+   ++fSnapshots;
+}
@@ -0,0 +1,107 @@
+#include "NumaTopology.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <sched.h>
+
+#include "Globals.h"
+
+NumaTopology& NumaTopology::Get()
+{
+   static NumaTopology topology;
+   return topology;
+}
+
+NumaTopology::NumaTopology()
+{
+   /// Reads the cores of all nodes, and keeps only the cores in our affinity mask (e.g. of a batch job).
+   cpu_set_t allowed;
+   CPU_ZERO(&allowed);
+   bool haveMask = (sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+   // node numbers don't have to be contiguous, so we try a few more after the first missing one
+   for(int node = 0, missing = 0; missing < 8; ++node) {
+      std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      std::string   list;
+      if(!std::getline(file, list)) {
+         ++missing;
+         continue;
+      }
+      missing = 0;
+      std::vector<int> cpus;
+      for(auto cpu : ParseList(list)) {
+         if(!haveMask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) { cpus.push_back(cpu); }
+      }
+      if(!cpus.empty()) { fCpus.push_back(cpus); }
+   }
+}
+
+std::vector<int> NumaTopology::ParseList(const std::string& list)
+{
+   std::vector<int>  cpus;
+   std::stringstream str(list);
+   std::string       range;
+   while(std::getline(str, range, ',')) {
+      if(range.empty()) { continue; }
+      auto dash = range.find('-');
+      try {
+         int first = std::stoi(range.substr(0, dash));
+         int last  = (dash == std::string::npos ? first : std::stoi(range.substr(dash + 1)));
+         for(int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+         }
+      } catch(std::exception&) {
+         // ignore anything we can't parse
+      }
+   }
+   return cpus;
+}
+
+int NumaTopology::Cpu(unsigned int slot) const
+{
+   const auto& cpus = fCpus[Node(slot)];
+   return cpus[(slot / Nodes()) % cpus.size()];
+}
+
+bool NumaTopology::Enable(unsigned int nSlots)
+{
+   if(Nodes() < 2) {
+      std::cout << "Found " << (Nodes() == 0 ? "no" : "only one") << " NUMA node" << (Nodes() == 0 ? "s" : "") << " we can run on, not pinning any threads" << std::endl;
+      fEnabled = false;
+      return fEnabled;
+   }
+   fEnabled    = true;
+   fMainThread = std::this_thread::get_id();
+   std::cout << "Placing " << nSlots << " slot(s) on " << Nodes() << " NUMA nodes:" << std::endl;
+   for(size_t node = 0; node < Nodes(); ++node) {
+      std::cout << "   node " << node << " (" << Cpus(node).size() << " cores):";
+      for(unsigned int slot = 0; slot < nSlots; ++slot) {
+         if(Node(slot) == node) { std::cout << " slot " << slot << " -> cpu " << Cpu(slot) << ";"; }
+      }
+      std::cout << std::endl;
+   }
+   for(size_t node = 0; node < Nodes(); ++node) {
+      // slots are assigned round-robin, so the first nodes get one more slot if the number isn't divisible
+      if((nSlots + Nodes() - 1 - node) / Nodes() > Cpus(node).size()) {
+         std::cout << DYELLOW << "More slots than cores on node " << node << ", some slots share a core" << RESET_COLOR << std::endl;
+         break;
+      }
+   }
+   return fEnabled;
+}
+
+bool NumaTopology::Pin(unsigned int slot)
+{
+   if(!fEnabled || std::this_thread::get_id() == fMainThread) { return false; }
+   cpu_set_t set;
+   CPU_ZERO(&set);
+   CPU_SET(Cpu(slot), &set);
+   if(sched_setaffinity(0, sizeof(set), &set) == 0) { return true; }
+   if(!fFailed.exchange(true)) {
+      std::cerr << DYELLOW << "Failed to pin thread of slot " << slot << " to cpu " << Cpu(slot) << ": " << std::strerror(errno) << RESET_COLOR << std::endl;
+   }
+   return false;
+}
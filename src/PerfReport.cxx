@@ -0,0 +1,140 @@
+#include "PerfReport.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <sys/resource.h>
+
+#include "TFile.h"
+
+#include "MappedFile.h"
+
+namespace {
+std::string JsonString(const std::string& val)
+{
+   /// returns the string in quotes, escaping quotes and backslashes
+   std::string result = "\"";
+   for(const auto& c : val) {
+      if(c == '"' || c == '\\') { result.push_back('\\'); }
+      result.push_back(c);
+   }
+   result.push_back('"');
+   return result;
+}
+}   // namespace
+
+size_t PerfReport::FindPhase(const std::string& phase) const
+{
+   return static_cast<size_t>(std::find(fPhases.begin(), fPhases.end(), phase) - fPhases.begin());
+}
+
+void PerfReport::Start(const std::string& phase)
+{
+   auto index = FindPhase(phase);
+   if(index == fPhases.size()) {
+      fPhases.push_back(phase);
+      fWatches.emplace_back();
+      fRunning.push_back(false);
+      fWatches.back().Start(true);
+   } else if(!fRunning[index]) {
+      fWatches[index].Continue();
+   }
+   fRunning[index] = true;
+}
+
+void PerfReport::Stop(const std::string& phase)
+{
+   auto index = FindPhase(phase);
+   if(index == fPhases.size() || !fRunning[index]) {
+      return;
+   }
+   fWatches[index].Stop();
+   fRunning[index] = false;
+}
+
+void PerfReport::AddSlotEvents(const std::vector<ULong64_t>& events, const std::vector<double>& busy)
+{
+   if(fSlotEvents.size() < events.size()) {
+      fSlotEvents.resize(events.size(), 0);
+      fSlotBusy.resize(events.size(), 0.);
+   }
+   for(size_t slot = 0; slot < events.size(); ++slot) {
+      fSlotEvents[slot] += events[slot];
+      fSlotBusy[slot] += slot < busy.size() ? busy[slot] : 0.;
+   }
+}
+
+void PerfReport::Write(const std::string& fileName)
+{
+   /// Writes all information collected as JSON file. Times are in seconds, sizes in bytes.
+   std::ofstream output(fileName);
+   if(!output.is_open()) {
+      std::cerr << DRED << "Failed to open performance report file \"" << fileName << "\"!" << RESET_COLOR << std::endl;
+      return;
+   }
+
+   output << std::setprecision(6) << std::fixed;
+   output << "{" << std::endl;
+
+   // phases
+   double loopTime = 0.;
+   output << "  \"phases\": [" << std::endl;
+   for(size_t phase = 0; phase < fPhases.size(); ++phase) {
+      // RealTime and CpuTime stop the watch, so this is only done at the very end
+      double real = fWatches[phase].RealTime();
+      double cpu  = fWatches[phase].CpuTime();
+      if(fPhases[phase] == "event loop") { loopTime = real; }
+      output << "    {\"name\": " << JsonString(fPhases[phase]) << ", \"wall\": " << real << ", \"cpu\": " << cpu << "}" << (phase + 1 < fPhases.size() ? "," : "") << std::endl;
+   }
+   output << "  ]," << std::endl;
+
+   // throughput
+   output << "  \"events\": " << fEvents << "," << std::endl;
+   output << "  \"events_per_second\": " << (loopTime > 0. ? static_cast<double>(fEvents) / loopTime : 0.) << "," << std::endl;
+   output << "  \"slots\": [" << std::endl;
+   for(size_t slot = 0; slot < fSlotEvents.size(); ++slot) {
+      // the rate of each slot is based on the time it was busy, not the wall time of the whole loop
+      output << "    {\"slot\": " << slot << ", \"events\": " << fSlotEvents[slot] << ", \"busy\": " << fSlotBusy[slot] << ", \"events_per_second\": " << (fSlotBusy[slot] > 0. ? static_cast<double>(fSlotEvents[slot]) / fSlotBusy[slot] : 0.) << "}" << (slot + 1 < fSlotEvents.size() ? "," : "") << std::endl;
+   }
+   output << "  ]," << std::endl;
+   // load imbalance is the ratio of the busy time of the busiest slot to the average busy time (1 = perfectly balanced)
+   double imbalance = 0.;
+   if(!fSlotBusy.empty()) {
+      double mean = std::accumulate(fSlotBusy.begin(), fSlotBusy.end(), 0.) / static_cast<double>(fSlotBusy.size());
+      if(mean > 0.) {
+         imbalance = *std::max_element(fSlotBusy.begin(), fSlotBusy.end()) / mean;
+      }
+   }
+   output << "  \"slot_imbalance\": " << imbalance << "," << std::endl;
+
+   // I/O and memory
+   rusage usage{};
+   getrusage(RUSAGE_SELF, &usage);
+#ifdef OS_DARWIN
+   Long64_t peakRss = usage.ru_maxrss;   // already in bytes on macOS
+#else
+   Long64_t peakRss = static_cast<Long64_t>(usage.ru_maxrss) * 1024;   // kB on linux
+#endif
+   // reads served from mappings aren't part of the counters of TFile, which only count real reads
+   output << "  \"bytes_read\": " << TFile::GetFileBytesRead() + MappedFile::MappedBytes() << "," << std::endl;
+   output << "  \"read_calls\": " << TFile::GetFileReadCalls() << "," << std::endl;
+   output << "  \"mapped_reads\": " << MappedFile::MappedReads() << "," << std::endl;
+   output << "  \"mapped_bytes\": " << MappedFile::MappedBytes() << "," << std::endl;
+   output << "  \"peak_rss\": " << peakRss << "," << std::endl;
+
+   // output objects
+   Long64_t total = 0;
+   output << "  \"objects_slots\": " << fSlots << "," << std::endl;
+   output << "  \"objects\": [" << std::endl;
+   for(auto object = fObjectSizes.begin(); object != fObjectSizes.end(); ++object) {
+      total += object->second;
+      output << "    {\"name\": " << JsonString(object->first) << ", \"bytes\": " << object->second << "}" << (std::next(object) != fObjectSizes.end() ? "," : "") << std::endl;
+   }
+   output << "  ]," << std::endl;
+   output << "  \"objects_bytes_per_slot\": " << total << std::endl;
+   output << "}" << std::endl;
+
+   output.close();
+   std::cout << "Wrote performance report to " << fileName << std::endl;
+}
@@ -0,0 +1,138 @@
+#include "Profiler.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+Profiler& Profiler::Get()
+{
+   static Profiler profiler;
+   return profiler;
+}
+
+uint64_t Profiler::Ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+   return __rdtsc();
+#else
+   return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void Profiler::Reset(unsigned int nSlots)
+{
+   /// The sections and counters stay registered (their ids are static at each call site).
+   std::lock_guard<std::mutex> lock(fMutex);
+   fSlots.clear();
+   for(unsigned int slot = 0; slot < nSlots; ++slot) {
+      fSlots.emplace_back(new SlotData);
+   }
+   fStartTicks = Ticks();
+   fStartTime  = std::chrono::steady_clock::now();
+}
+
+size_t Profiler::Register(std::vector<std::string>& names, const char* name)
+{
+   std::lock_guard<std::mutex> lock(fMutex);
+   auto                        it = std::find(names.begin(), names.end(), name);
+   if(it != names.end()) {
+      return static_cast<size_t>(std::distance(names.begin(), it));
+   }
+   names.emplace_back(name);
+   return names.size() - 1;
+}
+
+void Profiler::Report(const std::string& prefix, const std::map<std::string, std::vector<double>>& fills)
+{
+   /// This should only be called once all threads are done (e.g. in Finalize).
+   if(!Active()) {
+      return;
+   }
+
+   // convert ticks to nanoseconds using the time passed since the profiler was reset
+   double elapsedNs   = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - fStartTime).count();
+   double ticksPerNs  = (elapsedNs > 0. ? static_cast<double>(Ticks() - fStartTicks) / elapsedNs : 1.);
+   auto   nanoseconds = [ticksPerNs](uint64_t ticks) { return static_cast<double>(ticks) / ticksPerNs; };
+
+   // sum up all slots, using the path of each section (names separated by ';') as key
+   struct Sum {
+      uint64_t fTicks{0};
+      uint64_t fSelfTicks{0};
+      uint64_t fCalls{0};
+      size_t   fDepth{0};
+   };
+   std::map<std::string, Sum> sums;
+   std::vector<uint64_t>      counters(fCounters.size(), 0);
+   for(const auto& data : fSlots) {
+      // the root node (0) has no section, so we start with its children
+      std::vector<std::pair<size_t, std::string>> stack;
+      for(auto child : data->fNodes[0].fChildren) {
+         stack.emplace_back(child, fSections[data->fNodes[child].fSection]);
+      }
+      while(!stack.empty()) {
+         auto [index, path] = stack.back();
+         stack.pop_back();
+         const auto& node = data->fNodes[index];
+         auto&       sum  = sums[path];
+         sum.fTicks += node.fTicks;
+         sum.fCalls += node.fCalls;
+         sum.fDepth     = static_cast<size_t>(std::count(path.begin(), path.end(), ';'));
+         uint64_t child = 0;
+         for(auto childIndex : node.fChildren) {
+            child += data->fNodes[childIndex].fTicks;
+            stack.emplace_back(childIndex, path + ";" + fSections[data->fNodes[childIndex].fSection]);
+         }
+         sum.fSelfTicks += (node.fTicks > child ? node.fTicks - child : 0);
+      }
+      for(size_t counter = 0; counter < data->fCounters.size(); ++counter) {
+         counters[counter] += data->fCounters[counter];
+      }
+   }
+
+   std::ostringstream str;
+   str << "Profile of " << prefix << " (" << fSlots.size() << " slots, " << std::setprecision(3) << ticksPerNs << " ticks/ns):" << std::endl;
+   str << std::left << std::setw(40) << "section" << std::right << std::setw(14) << "calls" << std::setw(14) << "total [ms]" << std::setw(14) << "self [ms]" << std::setw(14) << "ns/call" << std::endl;
+   str << std::fixed;
+   for(const auto& sum : sums) {
+      // indent by depth and only print the last part of the path
+      std::string name = std::string(2 * sum.second.fDepth, ' ') + sum.first.substr(sum.first.find_last_of(';') + 1);
+      double      total = nanoseconds(sum.second.fTicks);
+      str << std::left << std::setw(40) << name << std::right << std::setw(14) << sum.second.fCalls
+          << std::setw(14) << std::setprecision(3) << total / 1e6 << std::setw(14) << nanoseconds(sum.second.fSelfTicks) / 1e6
+          << std::setw(14) << std::setprecision(1) << (sum.second.fCalls > 0 ? total / static_cast<double>(sum.second.fCalls) : 0.) << std::endl;
+   }
+   if(!fCounters.empty()) {
+      str << std::left << std::setw(40) << "counter" << std::right << std::setw(14) << "count" << std::endl;
+      for(size_t counter = 0; counter < fCounters.size(); ++counter) {
+         str << std::left << std::setw(40) << fCounters[counter] << std::right << std::setw(14) << counters[counter] << std::endl;
+      }
+   }
+   if(!fills.empty()) {
+      str << std::left << std::setw(40) << "histogram" << std::right << std::setw(14) << "fills" << "   fills per slot" << std::endl;
+      str << std::setprecision(0);
+      for(const auto& hist : fills) {
+         double total = 0.;
+         for(auto fill : hist.second) { total += fill; }
+         str << std::left << std::setw(40) << hist.first << std::right << std::setw(14) << total << "  ";
+         for(auto fill : hist.second) { str << " " << fill; }
+         str << std::endl;
+      }
+   }
+   std::cout << str.str();
+
+   // folded stacks use the self time of each section in microseconds as "samples"
+   std::string   foldedName = prefix + ".folded";
+   std::ofstream folded(foldedName);
+   for(const auto& sum : sums) {
+      auto samples = static_cast<uint64_t>(nanoseconds(sum.second.fSelfTicks) / 1e3);
+      if(samples > 0) {
+         folded << prefix << ";" << sum.first << " " << samples << std::endl;
+      }
+   }
+   std::cout << "Wrote folded stacks for flame graphs to " << foldedName << std::endl;
+}
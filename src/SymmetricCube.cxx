@@ -0,0 +1,99 @@
+#include "SymmetricCube.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "Globals.h"
+
+SymmetricCube::SymmetricCube(const char* name, const char* title, int bins, double low, double high)
+   : TNamed(name, title), fBins(bins), fLow(low), fHigh(high), fScale(bins / (high - low)), fData(static_cast<size_t>(bins) * (bins + 1) * (bins + 2) / 6, 0.F)
+{
+}
+
+void SymmetricCube::Add(const SymmetricCube* other)
+{
+   if(other->fBins != fBins || other->fLow != fLow || other->fHigh != fHigh) {
+      std::ostringstream str;
+      str << DRED << "Can't add symmetric cube " << other->GetName() << " to " << GetName() << ", the binning is different!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   for(size_t i = 0; i < fData.size(); ++i) {
+      fData[i] += other->fData[i];
+   }
+}
+
+Long64_t SymmetricCube::Merge(TCollection* list)
+{
+   /// Used by hadd and TFileMerger.
+   TIter next(list);
+   while(auto* obj = next()) {
+      auto* other = dynamic_cast<SymmetricCube*>(obj);
+      if(other != nullptr) { Add(other); }
+   }
+   return 0;
+}
+
+std::pair<int, int> SymmetricCube::Gate(double low, double high) const
+{
+   return {std::max(0, static_cast<int>((low - fLow) * fScale)), std::min(fBins - 1, static_cast<int>((high - fLow) * fScale))};
+}
+
+TH3F* SymmetricCube::Expand() const
+{
+   auto* hist = new TH3F(GetName(), GetTitle(), fBins, fLow, fHigh, fBins, fLow, fHigh, fBins, fLow, fHigh);
+   hist->SetDirectory(nullptr);
+   for(int k = 0; k < fBins; ++k) {
+      for(int j = 0; j <= k; ++j) {
+         for(int i = 0; i <= j; ++i) {
+            double content = Get(i, j, k);
+            if(content == 0.) { continue; }
+            // all permutations of (i, j, k), for equal indices some of them are the same bin
+            hist->SetBinContent(i + 1, j + 1, k + 1, content);
+            hist->SetBinContent(i + 1, k + 1, j + 1, content);
+            hist->SetBinContent(j + 1, i + 1, k + 1, content);
+            hist->SetBinContent(j + 1, k + 1, i + 1, content);
+            hist->SetBinContent(k + 1, i + 1, j + 1, content);
+            hist->SetBinContent(k + 1, j + 1, i + 1, content);
+         }
+      }
+   }
+   hist->ResetStats();
+   return hist;
+}
+
+TH2D* SymmetricCube::Project(double low, double high) const
+{
+   auto* hist = new TH2D(Form("%s_%g_%g", GetName(), low, high), Form("%s gated on %g - %g", GetTitle(), low, high), fBins, fLow, fHigh, fBins, fLow, fHigh);
+   hist->SetDirectory(nullptr);
+   auto gate = Gate(low, high);
+   for(int g = gate.first; g <= gate.second; ++g) {
+      for(int j = 0; j < fBins; ++j) {
+         for(int i = 0; i <= j; ++i) {
+            double content = Get(g, i, j);
+            if(content == 0.) { continue; }
+            hist->AddBinContent(hist->GetBin(i + 1, j + 1), content);
+            if(i != j) { hist->AddBinContent(hist->GetBin(j + 1, i + 1), content); }
+         }
+      }
+   }
+   hist->ResetStats();
+   return hist;
+}
+
+TH1D* SymmetricCube::Project(double low1, double high1, double low2, double high2) const
+{
+   auto* hist = new TH1D(Form("%s_%g_%g_%g_%g", GetName(), low1, high1, low2, high2), Form("%s gated on %g - %g and %g - %g", GetTitle(), low1, high1, low2, high2), fBins, fLow, fHigh);
+   hist->SetDirectory(nullptr);
+   auto gate1 = Gate(low1, high1);
+   auto gate2 = Gate(low2, high2);
+   for(int g1 = gate1.first; g1 <= gate1.second; ++g1) {
+      for(int g2 = gate2.first; g2 <= gate2.second; ++g2) {
+         for(int bin = 0; bin < fBins; ++bin) {
+            hist->AddBinContent(bin + 1, Get(g1, g2, bin));
+         }
+      }
+   }
+   hist->ResetStats();
+   return hist;
+}
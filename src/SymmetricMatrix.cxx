@@ -0,0 +1,67 @@
+#include "SymmetricMatrix.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "Globals.h"
+
+SymmetricMatrix::SymmetricMatrix(const char* name, const char* title, int bins, double low, double high)
+   : TNamed(name, title), fBins(bins), fLow(low), fHigh(high), fScale(bins / (high - low)), fData(static_cast<size_t>(bins) * (bins + 1) / 2, 0.F)
+{
+}
+
+void SymmetricMatrix::Add(const SymmetricMatrix* other)
+{
+   if(other->fBins != fBins || other->fLow != fLow || other->fHigh != fHigh) {
+      std::ostringstream str;
+      str << DRED << "Can't add symmetric matrix " << other->GetName() << " to " << GetName() << ", the binning is different!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   for(size_t i = 0; i < fData.size(); ++i) {
+      fData[i] += other->fData[i];
+   }
+}
+
+Long64_t SymmetricMatrix::Merge(TCollection* list)
+{
+   /// Used by hadd and TFileMerger.
+   TIter next(list);
+   while(auto* obj = next()) {
+      auto* other = dynamic_cast<SymmetricMatrix*>(obj);
+      if(other != nullptr) { Add(other); }
+   }
+   return 0;
+}
+
+TH2F* SymmetricMatrix::Expand() const
+{
+   auto* hist = new TH2F(GetName(), GetTitle(), fBins, fLow, fHigh, fBins, fLow, fHigh);
+   hist->SetDirectory(nullptr);
+   for(int j = 0; j < fBins; ++j) {
+      for(int i = 0; i <= j; ++i) {
+         double content = Get(i, j);
+         if(content == 0.) { continue; }
+         hist->SetBinContent(i + 1, j + 1, content);
+         hist->SetBinContent(j + 1, i + 1, content);
+      }
+   }
+   hist->ResetStats();
+   return hist;
+}
+
+TH1D* SymmetricMatrix::Project(double low, double high) const
+{
+   auto* hist = new TH1D(Form("%s_%g_%g", GetName(), low, high), Form("%s gated on %g - %g", GetTitle(), low, high), fBins, fLow, fHigh);
+   hist->SetDirectory(nullptr);
+   // the gate includes all bins that overlap with [low, high]
+   int first = std::max(0, static_cast<int>((low - fLow) * fScale));
+   int last  = std::min(fBins - 1, static_cast<int>((high - fLow) * fScale));
+   for(int gate = first; gate <= last; ++gate) {
+      for(int bin = 0; bin < fBins; ++bin) {
+         hist->AddBinContent(bin + 1, Get(gate, bin));
+      }
+   }
+   hist->ResetStats();
+   return hist;
+}
@@ -0,0 +1,339 @@
+#include "TiledHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "TClass.h"
+#include "TArrayC.h"
+#include "TArrayS.h"
+#include "TArrayI.h"
+#include "TArrayF.h"
+
+#include "Globals.h"
+#include "SymmetricCube.h"
+
+namespace {
+/// Copies (or adds) x-bins low to high of source to bins low - shift to high - shift of target, for all other bins
+/// (including under- and overflow). Both histograms need to have the same binning of the other axes.
+void CopyBins(const TH1* source, TH1* target, int low, int high, int shift, bool add)
+{
+   const int  yCells = source->GetDimension() > 1 ? source->GetNbinsY() + 2 : 1;
+   const int  zCells = source->GetDimension() > 2 ? source->GetNbinsZ() + 2 : 1;
+   const bool errors = source->GetSumw2N() > 0;
+   for(int z = 0; z < zCells; ++z) {
+      for(int y = 0; y < yCells; ++y) {
+         for(int x = low; x <= high; ++x) {
+            int    sourceBin = source->GetBin(x, y, z);
+            int    targetBin = target->GetBin(x - shift, y, z);
+            double content   = source->GetBinContent(sourceBin);
+            double error     = errors ? source->GetBinError(sourceBin) : 0.;
+            if(add) {
+               error = std::hypot(error, target->GetBinError(targetBin));
+               content += target->GetBinContent(targetBin);
+            }
+            target->SetBinContent(targetBin, content);
+            if(errors) { target->SetBinError(targetBin, error); }
+         }
+      }
+   }
+}
+
+std::vector<double> Edges(const TAxis* axis)
+{
+   std::vector<double> result(axis->GetNbins() + 1);
+   for(int bin = 1; bin <= axis->GetNbins() + 1; ++bin) {
+      result[bin - 1] = axis->GetBinLowEdge(bin);
+   }
+   return result;
+}
+}   // namespace
+
+Long64_t TiledHistogram::Size(const TH1* hist)
+{
+   /// This is used instead of streaming the histogram, which doesn't work for histograms this large.
+   Long64_t bytes = 8;
+   if(hist->InheritsFrom(TArrayF::Class()) || hist->InheritsFrom(TArrayI::Class())) {
+      bytes = 4;
+   } else if(hist->InheritsFrom(TArrayS::Class())) {
+      bytes = 2;
+   } else if(hist->InheritsFrom(TArrayC::Class())) {
+      bytes = 1;
+   }
+   if(hist->GetSumw2N() > 0) { bytes += 8; }
+   return bytes * hist->GetNcells();
+}
+
+TiledHistogram::TiledHistogram(TH1* hist)
+   : TNamed(hist->GetName(), hist->GetTitle()), fClassName(hist->ClassName()), fDimension(hist->GetDimension()), fSumw2(hist->GetSumw2N() > 0), fEntries(hist->GetEntries()), fSource(hist)
+{
+   fXEdges = Edges(hist->GetXaxis());
+   if(fDimension > 1) { fYEdges = Edges(hist->GetYaxis()); }
+   if(fDimension > 2) { fZEdges = Edges(hist->GetZaxis()); }
+   fAxisTitles = {hist->GetXaxis()->GetTitle(), hist->GetYaxis()->GetTitle(), hist->GetZaxis()->GetTitle()};
+   Split(Size(hist) / hist->GetNcells());
+}
+
+TiledHistogram::TiledHistogram(SymmetricCube* cube)
+   : TNamed(cube->GetName(), cube->GetTitle()), fClassName("TH3F"), fDimension(3), fCube(cube)
+{
+   fXEdges.resize(cube->Bins() + 1);
+   for(int bin = 0; bin <= cube->Bins(); ++bin) {
+      fXEdges[bin] = cube->Low() + bin * (cube->High() - cube->Low()) / cube->Bins();
+   }
+   fYEdges = fXEdges;
+   fZEdges = fXEdges;
+   // the title of the cube still has the axis titles in it ("title;x;y;z"), a histogram would have split them off
+   std::istringstream title(cube->GetTitle());
+   std::string        part;
+   std::getline(title, part, ';');
+   SetTitle(part.c_str());
+   fAxisTitles.resize(3);
+   for(auto& axisTitle : fAxisTitles) {
+      std::getline(title, axisTitle, ';');
+   }
+   Split(sizeof(float));
+}
+
+TiledHistogram::~TiledHistogram()
+{
+   delete fSource;
+   delete fCube;
+}
+
+void TiledHistogram::Split(Long64_t bytesPerCell)
+{
+   // each tile gets as many x-bins as fit into the tile size (at least one)
+   Long64_t bytesPerSlab = bytesPerCell * Cells(1) * Cells(2);
+   int      binsPerTile  = static_cast<int>(std::max(static_cast<Long64_t>(1), kTileSize / bytesPerSlab));
+   for(int bin = 1; bin <= NbinsX(); bin += binsPerTile) {
+      fFirstBin.push_back(bin);
+   }
+   fFirstBin.push_back(NbinsX() + 1);
+}
+
+int TiledHistogram::Cells(int axis) const
+{
+   /// Number of bins (including under- and overflow) of the y- (axis = 1) or z-axis (axis = 2), 1 if the histogram
+   /// doesn't have this axis.
+   const auto& edges = (axis == 1 ? fYEdges : fZEdges);
+   return edges.empty() ? 1 : static_cast<int>(edges.size()) + 1;
+}
+
+int TiledHistogram::FindBin(double x) const
+{
+   return static_cast<int>(std::upper_bound(fXEdges.begin(), fXEdges.end(), x) - fXEdges.begin());
+}
+
+int TiledHistogram::TileOf(int bin) const
+{
+   return static_cast<int>(std::upper_bound(fFirstBin.begin(), fFirstBin.end(), bin) - fFirstBin.begin()) - 1;
+}
+
+TH1* TiledHistogram::Create(const char* name, int firstBin, int lastBin) const
+{
+   auto* cls = TClass::GetClass(fClassName.c_str());
+   if(cls == nullptr) {
+      std::ostringstream str;
+      str << DRED << "Failed to find class " << fClassName << " of tiled histogram " << GetName() << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   auto* hist = static_cast<TH1*>(cls->New());
+   hist->SetDirectory(nullptr);
+   hist->SetNameTitle(name, GetTitle());
+   const int     nx = lastBin - firstBin + 1;
+   const double* x  = fXEdges.data() + firstBin - 1;
+   switch(fDimension) {
+   case 1: hist->SetBins(nx, x); break;
+   case 2: hist->SetBins(nx, x, static_cast<int>(fYEdges.size()) - 1, fYEdges.data()); break;
+   default: hist->SetBins(nx, x, static_cast<int>(fYEdges.size()) - 1, fYEdges.data(), static_cast<int>(fZEdges.size()) - 1, fZEdges.data()); break;
+   }
+   if(fSumw2) { hist->Sumw2(); }
+   hist->GetXaxis()->SetTitle(fAxisTitles[0].c_str());
+   hist->GetYaxis()->SetTitle(fAxisTitles[1].c_str());
+   hist->GetZaxis()->SetTitle(fAxisTitles[2].c_str());
+   return hist;
+}
+
+Int_t TiledHistogram::Write(const char* name, Int_t option, Int_t bufsize)
+{
+   return const_cast<const TiledHistogram*>(this)->Write(name, option, bufsize);   // NOLINT(cppcoreguidelines-pro-type-const-cast)
+}
+
+Int_t TiledHistogram::Write(const char* name, Int_t option, Int_t bufsize) const
+{
+   // a descriptor read from file has no histogram to create the tiles from, so we only write the descriptor itself
+   Int_t bytes = 0;
+   for(int tile = 0; (fSource != nullptr || fCube != nullptr) && tile < Tiles(); ++tile) {
+      TH1* hist = Create(Form("%s_tile%d", GetName(), tile), fFirstBin[tile], fFirstBin[tile + 1] - 1);
+      if(fCube != nullptr) {
+         FillFromCube(hist, fFirstBin[tile], fFirstBin[tile + 1] - 1);
+      } else {
+         // the under- and overflow of the x-axis go into the first and last tile
+         int low  = (tile == 0 ? 0 : fFirstBin[tile]);
+         int high = (tile == Tiles() - 1 ? NbinsX() + 1 : fFirstBin[tile + 1] - 1);
+         CopyBins(fSource, hist, low, high, fFirstBin[tile] - 1, false);
+      }
+      hist->ResetStats();
+      bytes += hist->Write(nullptr, option, bufsize);
+      delete hist;
+   }
+   return bytes + TNamed::Write(name, option, bufsize);
+}
+
+void TiledHistogram::FillFromCube(TH1* tile, int firstBin, int lastBin) const
+{
+   /// The cube has no under- or overflow, values outside of its range are ignored when filling it.
+   const int bins = fCube->Bins();
+   for(int x = firstBin; x <= lastBin; ++x) {
+      for(int y = 1; y <= bins; ++y) {
+         for(int z = 1; z <= bins; ++z) {
+            double content = fCube->Get(x - 1, y - 1, z - 1);
+            if(content != 0.) { tile->SetBinContent(tile->GetBin(x - firstBin + 1, y, z), content); }
+         }
+      }
+   }
+}
+
+void TiledHistogram::AddToCube(const TH1* tile, int firstBin, int lastBin)
+{
+   // the full cube is symmetric, so only the bins with x <= y <= z are added (the others are permutations of them)
+   const int bins = fCube->Bins();
+   for(int x = firstBin; x <= lastBin; ++x) {
+      for(int y = x; y <= bins; ++y) {
+         for(int z = y; z <= bins; ++z) {
+            double content = tile->GetBinContent(tile->GetBin(x - firstBin + 1, y, z));
+            if(content != 0.) { fCube->AddBinContent(x - 1, y - 1, z - 1, content); }
+         }
+      }
+   }
+}
+
+bool TiledHistogram::AddExisting(TDirectory* directory)
+{
+   auto* existing = dynamic_cast<TiledHistogram*>(directory->Get(GetName()));
+   if(existing == nullptr) { return false; }
+   if((fSource == nullptr && fCube == nullptr) || existing->fClassName != fClassName || existing->fXEdges != fXEdges || existing->fYEdges != fYEdges || existing->fZEdges != fZEdges || existing->fFirstBin != fFirstBin) {
+      std::cout << DRED << "Tiled histogram " << GetName() << " in " << directory->GetPath() << " doesn't match ours, not adding it!" << RESET_COLOR << std::endl;
+      delete existing;
+      return false;
+   }
+   existing->SetDirectory(directory);
+   for(int tile = 0; tile < Tiles(); ++tile) {
+      TH1* hist = existing->Tile(tile);
+      if(fCube != nullptr) {
+         AddToCube(hist, fFirstBin[tile], fFirstBin[tile + 1] - 1);
+      } else {
+         int low  = (tile == 0 ? 0 : 1);
+         int high = (tile == Tiles() - 1 ? hist->GetNbinsX() + 1 : hist->GetNbinsX());
+         CopyBins(hist, fSource, low, high, 1 - fFirstBin[tile], true);
+      }
+      delete hist;
+   }
+   fEntries += existing->fEntries;
+   if(fSource != nullptr) { fSource->SetEntries(fEntries); }
+   delete existing;
+   return true;
+}
+
+TH1* TiledHistogram::Tile(int tile) const
+{
+   if(fDirectory == nullptr || tile < 0 || tile >= Tiles()) {
+      std::ostringstream str;
+      str << DRED << "Can't read tile " << tile << " of tiled histogram " << GetName() << " (" << Tiles() << " tiles), " << (fDirectory == nullptr ? "no directory set!" : "tile out of range!") << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   auto* hist = dynamic_cast<TH1*>(fDirectory->Get(Form("%s_tile%d", GetName(), tile)));
+   if(hist == nullptr) {
+      std::ostringstream str;
+      str << DRED << "Failed to find tile " << tile << " of tiled histogram " << GetName() << " in " << fDirectory->GetPath() << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   hist->SetDirectory(nullptr);
+   return hist;
+}
+
+TH1* TiledHistogram::Slice(int firstBin, int lastBin) const
+{
+   firstBin   = std::max(firstBin, 1);
+   lastBin    = std::min(lastBin, NbinsX());
+   auto* hist = Create(Form("%s_%d_%d", GetName(), firstBin, lastBin), firstBin, lastBin);
+   for(int tile = TileOf(firstBin); tile <= TileOf(lastBin); ++tile) {
+      TH1* part = Tile(tile);
+      int  low  = std::max(firstBin, fFirstBin[tile]);
+      int  high = std::min(lastBin, fFirstBin[tile + 1] - 1);
+      CopyBins(part, hist, low - fFirstBin[tile] + 1, high - fFirstBin[tile] + 1, firstBin - fFirstBin[tile], false);
+      delete part;
+   }
+   hist->ResetStats();
+   return hist;
+}
+
+TH1D* TiledHistogram::ProjectionX() const
+{
+   auto* projection = new TH1D(Form("%s_px", GetName()), GetTitle(), NbinsX(), fXEdges.data());
+   projection->SetDirectory(nullptr);
+   projection->GetXaxis()->SetTitle(fAxisTitles[0].c_str());
+   if(fSumw2) { projection->Sumw2(); }
+   // only the bins of the other axes are used, not their under- and overflow
+   const int yHigh = std::max(Cells(1) - 2, 0);
+   const int zHigh = std::max(Cells(2) - 2, 0);
+   for(int tile = 0; tile < Tiles(); ++tile) {
+      TH1* part = Tile(tile);
+      for(int x = 1; x <= part->GetNbinsX(); ++x) {
+         double content = 0.;
+         double error2  = 0.;
+         for(int z = std::min(zHigh, 1); z <= zHigh; ++z) {
+            for(int y = std::min(yHigh, 1); y <= yHigh; ++y) {
+               int bin = part->GetBin(x, y, z);
+               content += part->GetBinContent(bin);
+               error2 += std::pow(part->GetBinError(bin), 2);
+            }
+         }
+         projection->SetBinContent(x + fFirstBin[tile] - 1, content);
+         if(fSumw2) { projection->SetBinError(x + fFirstBin[tile] - 1, std::sqrt(error2)); }
+      }
+      delete part;
+   }
+   projection->ResetStats();
+   return projection;
+}
+
+TH1D* TiledHistogram::ProjectionY(int firstBin, int lastBin) const
+{
+   if(fDimension < 2) {
+      std::ostringstream str;
+      str << DRED << "Can't project the one-dimensional tiled histogram " << GetName() << " onto the y-axis!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   firstBin         = std::max(firstBin, 1);
+   lastBin          = std::min(lastBin, NbinsX());
+   auto* projection = new TH1D(Form("%s_py_%d_%d", GetName(), firstBin, lastBin), GetTitle(), static_cast<int>(fYEdges.size()) - 1, fYEdges.data());
+   projection->SetDirectory(nullptr);
+   projection->GetXaxis()->SetTitle(fAxisTitles[1].c_str());
+   projection->Sumw2();
+   const int zHigh = std::max(Cells(2) - 2, 0);
+   for(int tile = TileOf(firstBin); tile <= TileOf(lastBin); ++tile) {
+      TH1* part = Tile(tile);
+      int  low  = std::max(firstBin, fFirstBin[tile]) - fFirstBin[tile] + 1;
+      int  high = std::min(lastBin, fFirstBin[tile + 1] - 1) - fFirstBin[tile] + 1;
+      for(int y = 0; y < Cells(1); ++y) {
+         double content = projection->GetBinContent(y);
+         double error2  = std::pow(projection->GetBinError(y), 2);
+         for(int z = std::min(zHigh, 1); z <= zHigh; ++z) {
+            for(int x = low; x <= high; ++x) {
+               int bin = part->GetBin(x, y, z);
+               content += part->GetBinContent(bin);
+               error2 += std::pow(part->GetBinError(bin), 2);
+            }
+         }
+         projection->SetBinContent(y, content);
+         projection->SetBinError(y, std::sqrt(error2));
+      }
+      delete part;
+   }
+   projection->ResetStats();
+   return projection;
+}
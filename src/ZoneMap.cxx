@@ -0,0 +1,155 @@
+#include "ZoneMap.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "TFile.h"
+#include "TSystem.h"
+#include "TTreeFormula.h"
+
+#include "Globals.h"
+
+namespace {
+/// Creates a formula for the column, which only reads the branches it needs.
+std::unique_ptr<TTreeFormula> Formula(const std::string& column, TTree* tree)
+{
+   std::unique_ptr<TTreeFormula> formula(new TTreeFormula(column.c_str(), column.c_str(), tree));
+   if(formula->GetNdim() == 0) {
+      std::ostringstream str;
+      str << DRED << "Failed to find column '" << column << "' in tree '" << tree->GetName() << "'!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   for(int leaf = 0; leaf < formula->GetNcodes(); ++leaf) {
+      if(formula->GetLeaf(leaf) != nullptr) { tree->AddBranchToCache(formula->GetLeaf(leaf)->GetBranch(), true); }
+   }
+   return formula;
+}
+
+double Value(TTreeFormula& formula)
+{
+   formula.GetNdata();
+   return formula.EvalInstance();
+}
+}   // namespace
+
+ZoneMap::ZoneMap(TTree* tree, const std::vector<std::string>& columns)
+   : TNamed(kName, Form("zone map of %s", tree->GetName())), fColumns(columns)
+{
+   std::vector<std::unique_ptr<TTreeFormula>> formulas;
+   for(const auto& column : fColumns) {
+      formulas.push_back(Formula(column, tree));
+   }
+   const Long64_t entries  = tree->GetEntries();
+   auto           iterator = tree->GetClusterIterator(0);
+   for(Long64_t start = iterator(); start < entries; start = iterator()) {
+      fFirstEntry.push_back(start);
+      fMin.resize(fMin.size() + fColumns.size(), std::numeric_limits<double>::infinity());
+      fMax.resize(fMax.size() + fColumns.size(), -std::numeric_limits<double>::infinity());
+      fHasNaN.resize(fHasNaN.size() + fColumns.size(), 0);
+      double* min    = &fMin[fMin.size() - fColumns.size()];
+      double* max    = &fMax[fMax.size() - fColumns.size()];
+      char*   hasNaN = &fHasNaN[fHasNaN.size() - fColumns.size()];
+      for(Long64_t entry = start; entry < iterator.GetNextEntry(); ++entry) {
+         tree->LoadTree(entry);
+         for(size_t column = 0; column < formulas.size(); ++column) {
+            double value = Value(*formulas[column]);
+            if(std::isnan(value)) {
+               hasNaN[column] = 1;
+               continue;
+            }
+            min[column] = std::min(min[column], value);
+            max[column] = std::max(max[column], value);
+         }
+      }
+   }
+   fFirstEntry.push_back(entries);
+}
+
+std::string ZoneMap::FileName(const std::string& file)
+{
+   std::string name = file;
+   if(name.size() > 5 && name.compare(name.size() - 5, 5, ".root") == 0) { name.erase(name.size() - 5); }
+   return name + ".zonemap.root";
+}
+
+ZoneMap* ZoneMap::ForFile(const std::string& file, const std::string& treeName, const std::vector<std::string>& columns)
+{
+   TFile input(file.c_str());
+   auto* tree = dynamic_cast<TTree*>(input.Get(treeName.c_str()));
+   if(tree == nullptr) {
+      std::ostringstream str;
+      str << DRED << "Failed to find tree '" << treeName << "' in '" << file << "' for the zone map!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+
+   // AccessPathName returns true if the file does not exist
+   if(!gSystem->AccessPathName(FileName(file).c_str())) {
+      TFile zoneMapFile(FileName(file).c_str());
+      if(!zoneMapFile.IsZombie()) {
+         auto* zoneMap = dynamic_cast<ZoneMap*>(zoneMapFile.Get(kName));
+         if(zoneMap != nullptr) {
+            bool complete = (zoneMap->Complete() && zoneMap->Entries() == tree->GetEntries());
+            for(const auto& column : columns) {
+               if(zoneMap->Column(column) < 0) { complete = false; }
+            }
+            if(complete) { return zoneMap; }
+            delete zoneMap;
+         }
+      }
+   }
+
+   std::cout << "Building zone map of '" << file << "' for " << columns.size() << " column(s)" << std::endl;
+   auto* zoneMap = new ZoneMap(tree, columns);
+   TFile output(FileName(file).c_str(), "recreate");
+   if(output.IsZombie()) {
+      // we can still use it, it just has to be built again next time
+      std::cout << DYELLOW << "Failed to write zone map to '" << FileName(file) << "'" << RESET_COLOR << std::endl;
+   } else {
+      zoneMap->Write(kName);
+   }
+   return zoneMap;
+}
+
+int ZoneMap::Column(const std::string& column) const
+{
+   for(size_t i = 0; i < fColumns.size(); ++i) {
+      if(fColumns[i] == column) { return static_cast<int>(i); }
+   }
+   return -1;
+}
+
+void ZoneMap::Select(TTree* tree, const std::string& column, double low, double high, TEntryList& list, Counts& counts) const
+{
+   int index = Column(column);
+   if(index < 0) {
+      std::ostringstream str;
+      str << DRED << "Zone map of '" << tree->GetName() << "' doesn't have column '" << column << "'!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   std::unique_ptr<TTreeFormula> formula;   // only created if we need to read a cluster
+   for(size_t cluster = 0; cluster < Clusters(); ++cluster) {
+      if(Max(cluster, index) < low || Min(cluster, index) > high) {
+         ++counts.fSkipped;
+         continue;
+      }
+      // NaN values are never inside the range, so clusters with NaN values have to be read
+      if(!HasNaN(cluster, index) && Min(cluster, index) >= low && Max(cluster, index) <= high) {
+         for(Long64_t entry = First(cluster); entry < End(cluster); ++entry) {
+            list.Enter(entry);
+         }
+         ++counts.fComplete;
+         continue;
+      }
+      if(formula == nullptr) { formula = Formula(column, tree); }
+      for(Long64_t entry = First(cluster); entry < End(cluster); ++entry) {
+         tree->LoadTree(entry);
+         double value = Value(*formula);
+         if(value >= low && value <= high) { list.Enter(entry); }
+      }
+      ++counts.fRead;
+   }
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <vector>
+
+#include "TList.h"
+
+#include "BatchHelper.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Checks that a BatchHelper hands full batches of events to ExecBatch, with
+/// the values, offsets, events, and channels of the vector columns and the
+/// values of the scalar columns in order, and that the last, incomplete
+/// batch is processed in Finalize.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+namespace TestColumns {
+HIGS_COLUMN(Amplitude, "amplitude", double);
+HIGS_SCALAR_COLUMN(Entry, "rdfentry_", ULong64_t);
+}   // namespace TestColumns
+
+class TestBatchHelper : public BatchHelper<TestBatchHelper, 4, TestColumns::Amplitude, TestColumns::Entry> {
+public:
+   explicit TestBatchHelper(TList* input)
+      : BatchHelper(input)
+   {
+      Prefix("TestBatchHelper");
+      Setup();
+   }
+
+   void CreateHistograms(unsigned int) override {}
+
+   void ExecBatch(unsigned int, const Batch& batch)
+   {
+      using namespace TestColumns;
+      fSizes.push_back(batch.Size());
+      const auto& values  = batch.Values<Amplitude>();
+      const auto& offsets = batch.Offsets<Amplitude>();
+      const auto& events  = batch.Events<Amplitude>();
+      const auto& entries = batch.Values<Entry>();
+      for(size_t i = 0; i < values.size(); ++i) {
+         // event e has the values e, e + 1, ... (e + 1 values in total), so the value is the entry plus the channel
+         if(values[i] != static_cast<double>(entries[events[i]] + batch.Channels<Amplitude>()[i])) { ++fErrors; }
+      }
+      for(size_t event = 0; event < batch.Size(); ++event) {
+         if(offsets[event + 1] - offsets[event] != entries[event] + 1) { ++fErrors; }
+      }
+   }
+
+   std::vector<size_t> fSizes;
+   int                 fErrors{0};
+};
+
+int main()
+{
+   TList input;
+   auto* helper = new TestBatchHelper(&input);
+   helper->Initialize();
+   for(ULong64_t entry = 0; entry < 10; ++entry) {
+      ROOT::RVecD amplitude;
+      for(ULong64_t channel = 0; channel <= entry; ++channel) {
+         amplitude.push_back(static_cast<double>(entry + channel));
+      }
+      helper->Exec(0, amplitude, entry);
+   }
+   helper->Finalize();
+
+   if(helper->fSizes != std::vector<size_t>{4, 4, 2}) {
+      std::cerr << "got " << helper->fSizes.size() << " batches instead of batches of 4, 4, and 2 events" << std::endl;
+      return 1;
+   }
+   if(helper->fErrors != 0) {
+      std::cerr << helper->fErrors << " values or offsets of the batches were wrong" << std::endl;
+      return 1;
+   }
+   if(!helper->Batches()) {
+      std::cerr << "the helper isn't marked as processing batches" << std::endl;
+      return 1;
+   }
+
+   std::cout << "batches are complete and in order" << std::endl;
+   return 0;
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <cmath>
+
+#include "Coincidences.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Checks that hits with a NaN time are left out of the coincidences, so the
+/// hits can still be sorted and no pairs of valid hits are lost.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+   Coincidences coincidences(100., 500., 1000.);
+   coincidences.Clear();
+   coincidences.Add(0, 0, 1000., 30.);
+   coincidences.Add(0, 1, 1100., NAN);
+   coincidences.Add(0, 2, 1200., 10.);
+   coincidences.Add(0, 3, 1300., 20.);
+   coincidences.Add(0, 4, 1400., -INFINITY);
+   coincidences.Sort();
+
+   if(coincidences.Size() != 3) {
+      std::cerr << "got " << coincidences.Size() << " hits instead of the 3 hits with a valid time" << std::endl;
+      return 1;
+   }
+   for(size_t hit = 1; hit < coincidences.Size(); ++hit) {
+      if(coincidences.Time(hit) < coincidences.Time(hit - 1)) {
+         std::cerr << "hits aren't sorted by time: " << coincidences.Time(hit - 1) << " before " << coincidences.Time(hit) << std::endl;
+         return 1;
+      }
+   }
+
+   // all three valid hits are within 100 ns of each other
+   int pairs = 0;
+   coincidences.ForEachPair([&pairs](size_t, size_t, Coincidences::EWindow window) {
+      if(window == Coincidences::EWindow::kPrompt) { ++pairs; }
+   });
+   if(pairs != 3) {
+      std::cerr << "got " << pairs << " prompt pairs instead of 3" << std::endl;
+      return 1;
+   }
+
+   std::cout << "hits with a NaN time are ignored" << std::endl;
+   return 0;
+}
@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ROOT/RVec.hxx"
+
+#include "Calibration.h"
+#include "HitEvent.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Checks that two helpers with different calibrations get their own hit
+/// event of the same entry, each calibrated with their own calibration, while
+/// helpers with the same calibration and layout share one hit event.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+/// Writes a calibration file with the same gain for all 48 channels.
+std::string WriteCalibration(const std::string& name, double gain)
+{
+   std::ofstream file(name);
+   for(int i = 0; i < 48; ++i) {
+      file << "0. " << gain << std::endl;
+   }
+   file << "0. 1." << std::endl
+        << "0. 1." << std::endl;
+   return name;
+}
+
+/// What the Process of a helper does: gets the hit event of its calibration and layout, and builds it if it's new.
+HitEvent& Build(const Calibration* calibration, const std::string& layout, uint64_t entry, bool& built)
+{
+   auto& hits = HitEvent::ForSlot(0, calibration, layout);
+   built      = hits.Begin(entry);
+   if(built) {
+      hits.Add(0, 0, ROOT::RVecD{100.}, ROOT::RVecD{1.}, calibration);
+   }
+   return hits;
+}
+}   // namespace
+
+int main()
+{
+   auto        fileA = WriteCalibration("HitEventKeysA.cal", 1.);
+   auto        fileB = WriteCalibration("HitEventKeysB.cal", 2.);
+   Calibration calibrationA(fileA.c_str());
+   Calibration calibrationB(fileB.c_str());
+   std::remove(fileA.c_str());
+   std::remove(fileB.c_str());
+
+   HitEvent::Slots(1);
+   HitEvent::NewLoop();
+
+   // the first helper builds entry 3 with gain 1, i.e. energies in [100, 101)
+   bool  built = false;
+   auto& first = Build(&calibrationA, "cross", 3, built);
+   if(!built || first.Size() != 1 || first.Energy(0) >= 101.) {
+      std::cerr << "first helper: entry 3 wasn't built with its own calibration" << std::endl;
+      return 1;
+   }
+
+   // the second helper uses gain 2, so it has to build the same entry again, with energies in [200, 202)
+   auto& second = Build(&calibrationB, "cross", 3, built);
+   if(!built || second.Size() != 1 || second.Energy(0) < 200.) {
+      std::cerr << "second helper: got the hits of the first helper instead of its own calibration" << std::endl;
+      return 1;
+   }
+
+   // a third helper with the same calibration and layout as the first one shares its hit event
+   auto& third = Build(&calibrationA, "cross", 3, built);
+   if(built || &third != &first) {
+      std::cerr << "third helper: entry 3 was built again instead of sharing the hits of the first helper" << std::endl;
+      return 1;
+   }
+
+   // the same calibration with a different layout is a different hit event as well
+   Build(&calibrationA, "cross+back", 3, built);
+   if(!built) {
+      std::cerr << "fourth helper: a different detector layout used the hits of the first helper" << std::endl;
+      return 1;
+   }
+
+   std::cout << "hit events are kept per calibration and detector layout" << std::endl;
+   return 0;
+}
@@ -0,0 +1,46 @@
+#include <iostream>
+
+#include "ROOT/RVec.hxx"
+
+#include "HitEvent.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Checks that the hit event of a slot is built again in a new event loop
+/// (e.g. the next pass in follow mode), even if the first entry of the slot
+/// has the same entry number as its last entry in the previous loop.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+   HitEvent::Slots(1);
+   auto& hits = HitEvent::ForSlot(0, nullptr, "test");
+
+   // first pass, entry 5 with one hit
+   HitEvent::NewLoop();
+   if(!hits.Begin(5)) {
+      std::cerr << "first pass: entry 5 wasn't built" << std::endl;
+      return 1;
+   }
+   hits.Add(0, 0, ROOT::RVecD{100.}, ROOT::RVecD{1.}, nullptr);
+   if(hits.Begin(5)) {
+      std::cerr << "first pass: entry 5 was built twice" << std::endl;
+      return 1;
+   }
+
+   // second pass, entry numbers start again, entry 5 is a different event with two hits
+   HitEvent::NewLoop();
+   if(!hits.Begin(5)) {
+      std::cerr << "second pass: entry 5 wasn't built again, the hits of the first pass would be reused" << std::endl;
+      return 1;
+   }
+   hits.Add(0, 0, ROOT::RVecD{200., 300.}, ROOT::RVecD{1., 2.}, nullptr);
+   if(hits.Size() != 2 || hits.Energy(0) != 200.) {
+      std::cerr << "second pass: got " << hits.Size() << " hits instead of the 2 hits of the second pass" << std::endl;
+      return 1;
+   }
+
+   std::cout << "hit events are rebuilt in every event loop" << std::endl;
+   return 0;
+}